@@ -0,0 +1,231 @@
+#include <obs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <QCoreApplication>
+
+#include "receiver.hpp"
+#include "obs-stubs.hpp"
+
+// Drives the receiver's frame parsing and binding updates against the libobs
+// stubs, reporting what each pass over the bindings costs. Run it without
+// arguments for the standard table, or with a binding and source count for a
+// single workload.
+
+// every allocation in the process, so we can see what a pass costs in them
+static std::atomic<unsigned long long> allocations{0};
+
+void *operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+#define FIELD_LENGTH 8
+
+// offsets in the benchmark's score table: each binding reads its own field
+#define FIELD_OFFSET(n) ((n) * FIELD_LENGTH)
+
+#define SYN '\x16'
+#define SOH '\x01'
+#define STX '\x02'
+#define EOT '\x04'
+#define ETB '\x17'
+
+static std::string buildFrame(size_t offset, const std::string &body)
+{
+	char head[16];
+	snprintf(head, sizeof(head), "00421%05zu", offset % 100000);
+
+	std::string frame;
+	frame += SYN;
+	frame += SOH;
+	frame += head;
+	frame += STX;
+	frame += body;
+	frame += EOT;
+
+	// everything after the SYN, up to and including the EOT
+	uint8_t checksum = 0;
+	for (size_t i = 1; i < frame.size(); i++)
+		checksum += frame[i];
+
+	char sum[3];
+	snprintf(sum, sizeof(sum), "%02X", checksum);
+	frame += sum;
+	frame += ETB;
+
+	return frame;
+}
+
+struct Result {
+	double ns_per_pass;
+	double allocations_per_pass;
+	double updates_per_pass;
+	double lookups_per_pass;
+	double properties_per_pass;
+};
+
+class ReceiverBenchmark {
+public:
+	ReceiverBenchmark(size_t bindingCount, size_t sourceCount)
+	{
+		for (size_t i = 0; i < sourceCount; i++) {
+			std::string uuid = "source-" + std::to_string(i);
+			std::string name = "Source " + std::to_string(i);
+			stub_create_source(uuid.c_str(), name.c_str());
+		}
+
+		std::vector<BindingPtr> list;
+		for (size_t i = 0; i < bindingCount; i++) {
+			auto binding = std::make_shared<Binding>();
+			binding->enabled = true;
+			binding->name = "binding " + std::to_string(i);
+			binding->item_number = FIELD_OFFSET(i) + 1;
+			binding->field_length = FIELD_LENGTH;
+			binding->source_id = "source-" +
+					     std::to_string(i % sourceCount);
+			binding->parent_prop = {"text"};
+			list.push_back(binding);
+		}
+
+		// a single input, as if the receiver had been started
+		receiver.inputStats.assign(1, InputStats{});
+		receiver.inputProtocols.assign(1, PROTOCOL_RTD);
+		receiver.publishBindings(std::move(list));
+
+		// fill the whole table so every binding has something to read
+		std::string table(FIELD_OFFSET(bindingCount), ' ');
+		for (size_t i = 0; i < bindingCount; i++) {
+			std::string value = std::to_string(i % 1000);
+			table.replace(FIELD_OFFSET(i), value.size(), value);
+		}
+		receiver.processDatagram(buildFrame(0, table), 0);
+		receiver.updateSources(PRIORITY_IMMEDIATE);
+	}
+
+	~ReceiverBenchmark() { stub_destroy_sources(); }
+
+	// like a running clock: one field changes per frame, and every frame
+	// is followed by a pass over the bindings
+	Result run(size_t passes)
+	{
+		std::string frames[10];
+		for (int i = 0; i < 10; i++)
+			frames[i] = buildFrame(
+				0, std::string(FIELD_LENGTH - 1, ' ') +
+					   (char)('0' + i));
+
+		stub_reset_counters();
+		unsigned long long allocationsBefore = allocations.load();
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t pass = 0; pass < passes; pass++) {
+			receiver.processDatagram(frames[pass % 10], 0);
+			receiver.updateSources(PRIORITY_IMMEDIATE);
+		}
+
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		unsigned long long allocationsAfter = allocations.load();
+		StubCounters counters = stub_counters();
+
+		Result result;
+		result.ns_per_pass =
+			std::chrono::duration<double, std::nano>(elapsed)
+				.count() /
+			passes;
+		result.allocations_per_pass =
+			(double)(allocationsAfter - allocationsBefore) / passes;
+		result.updates_per_pass =
+			(double)counters.source_updates / passes;
+		result.lookups_per_pass =
+			(double)counters.source_lookups / passes;
+		result.properties_per_pass =
+			(double)counters.properties_built / passes;
+		return result;
+	}
+
+private:
+	Receiver receiver;
+};
+
+static void runWorkload(size_t bindings, size_t sources)
+{
+	// aim for roughly the same amount of work per row
+	size_t passes = std::max<size_t>(20, 200000 / bindings);
+
+	Result result = ReceiverBenchmark(bindings, sources).run(passes);
+
+	printf("%8zu %8zu %12.0f %10.1f %10.2f %10.2f %10.2f %10.2f\n",
+	       bindings, sources, result.ns_per_pass / 1000.0,
+	       result.ns_per_pass / bindings,
+	       result.allocations_per_pass / bindings,
+	       result.updates_per_pass / bindings,
+	       result.lookups_per_pass / bindings,
+	       result.properties_per_pass / bindings);
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+
+	printf("%8s %8s %12s %10s %10s %10s %10s %10s\n", "bindings",
+	       "sources", "us/pass", "ns/bind", "allocs/b", "updates/b",
+	       "lookups/b", "props/b");
+
+	if (argc == 3) {
+		size_t bindings = strtoul(argv[1], nullptr, 10);
+		size_t sources = strtoul(argv[2], nullptr, 10);
+		if (!bindings || !sources) {
+			fprintf(stderr, "usage: %s [bindings sources]\n",
+				argv[0]);
+			return 1;
+		}
+		runWorkload(bindings, sources);
+		return 0;
+	}
+
+	static const size_t workloads[][2] = {
+		{10, 1},     {10, 10},    {100, 10},   {100, 100},
+		{500, 50},   {500, 500},  {1000, 100}, {1000, 500},
+		{5000, 100}, {5000, 500},
+	};
+
+	for (auto &workload : workloads)
+		runWorkload(workload[0], workload[1]);
+
+	return 0;
+}
@@ -0,0 +1,653 @@
+#include <obs.h>
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <util/config-file.h>
+#include <util/platform.h>
+#include <util/dstr.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <strings.h>
+
+#include "obs-stubs.hpp"
+
+static StubCounters counters;
+
+/* ------------------------------------------------------------------------- */
+/* obs_data                                                                  */
+
+enum item_type { ITEM_STRING, ITEM_INT, ITEM_BOOL, ITEM_OBJ, ITEM_ARRAY };
+
+struct data_item {
+	item_type type;
+	std::string str;
+	long long num;
+	bool boolean;
+	obs_data_t *obj;
+	obs_data_array_t *arr;
+};
+
+struct obs_data {
+	long refs = 1;
+	std::map<std::string, data_item> items;
+	std::string json;
+};
+
+struct obs_data_array {
+	long refs = 1;
+	std::vector<obs_data_t *> items;
+};
+
+static void release_item(data_item &item)
+{
+	if (item.type == ITEM_OBJ)
+		obs_data_release(item.obj);
+	else if (item.type == ITEM_ARRAY)
+		obs_data_array_release(item.arr);
+}
+
+static data_item &set_item(obs_data_t *data, const char *name, item_type type)
+{
+	auto it = data->items.find(name);
+	if (it != data->items.end())
+		release_item(it->second);
+
+	data_item &item = data->items[name];
+	item = data_item{type, std::string(), 0, false, nullptr, nullptr};
+	return item;
+}
+
+static data_item *get_item(obs_data_t *data, const char *name, item_type type)
+{
+	if (!data)
+		return nullptr;
+
+	auto it = data->items.find(name);
+	if (it == data->items.end() || it->second.type != type)
+		return nullptr;
+	return &it->second;
+}
+
+obs_data_t *obs_data_create()
+{
+	return new obs_data;
+}
+
+obs_data_t *obs_data_create_from_json(const char *json_string)
+{
+	UNUSED_PARAMETER(json_string);
+	return obs_data_create();
+}
+
+// there are no files to load bindings from or save them to
+obs_data_t *obs_data_create_from_json_file_safe(const char *json_file,
+						const char *backup_ext)
+{
+	UNUSED_PARAMETER(json_file);
+	UNUSED_PARAMETER(backup_ext);
+	return nullptr;
+}
+
+bool obs_data_save_json_safe(obs_data_t *data, const char *file,
+			     const char *temp_ext, const char *backup_ext)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(file);
+	UNUSED_PARAMETER(temp_ext);
+	UNUSED_PARAMETER(backup_ext);
+	return false;
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+	if (data)
+		data->refs++;
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	if (!data || --data->refs)
+		return;
+
+	for (auto &item : data->items)
+		release_item(item.second);
+	delete data;
+}
+
+const char *obs_data_get_json(obs_data_t *data)
+{
+	// nothing in the benchmark reads the serialized form back
+	data->json = "{}";
+	return data->json.c_str();
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	set_item(data, name, ITEM_STRING).str = val ? val : "";
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	set_item(data, name, ITEM_INT).num = val;
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	set_item(data, name, ITEM_BOOL).boolean = val;
+}
+
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj)
+{
+	obs_data_addref(obj);
+	set_item(data, name, ITEM_OBJ).obj = obj;
+}
+
+void obs_data_set_array(obs_data_t *data, const char *name,
+			obs_data_array_t *array)
+{
+	obs_data_array_addref(array);
+	set_item(data, name, ITEM_ARRAY).arr = array;
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	data_item *item = get_item(data, name, ITEM_STRING);
+	return item ? item->str.c_str() : "";
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	data_item *item = get_item(data, name, ITEM_INT);
+	return item ? item->num : 0;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	data_item *item = get_item(data, name, ITEM_BOOL);
+	return item ? item->boolean : false;
+}
+
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name)
+{
+	data_item *item = get_item(data, name, ITEM_OBJ);
+	if (!item)
+		return nullptr;
+	obs_data_addref(item->obj);
+	return item->obj;
+}
+
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name)
+{
+	data_item *item = get_item(data, name, ITEM_ARRAY);
+	if (!item)
+		return nullptr;
+	obs_data_array_addref(item->arr);
+	return item->arr;
+}
+
+obs_data_array_t *obs_data_array_create()
+{
+	return new obs_data_array;
+}
+
+void obs_data_array_addref(obs_data_array_t *array)
+{
+	if (array)
+		array->refs++;
+}
+
+void obs_data_array_release(obs_data_array_t *array)
+{
+	if (!array || --array->refs)
+		return;
+
+	for (obs_data_t *item : array->items)
+		obs_data_release(item);
+	delete array;
+}
+
+size_t obs_data_array_count(obs_data_array_t *array)
+{
+	return array ? array->items.size() : 0;
+}
+
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx)
+{
+	if (!array || idx >= array->items.size())
+		return nullptr;
+	obs_data_addref(array->items[idx]);
+	return array->items[idx];
+}
+
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj)
+{
+	obs_data_addref(obj);
+	array->items.push_back(obj);
+	return array->items.size() - 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/* sources and properties                                                    */
+
+struct obs_property {
+	std::string name;
+	enum obs_property_type type;
+};
+
+struct obs_properties {
+	std::map<std::string, obs_property> props;
+};
+
+struct obs_source {
+	long refs = 1;
+	std::string uuid;
+	std::string name;
+	obs_data_t *settings;
+};
+
+static std::map<std::string, obs_source_t *> sources;
+
+obs_source_t *stub_create_source(const char *uuid, const char *name)
+{
+	obs_source_t *source = new obs_source;
+	source->uuid = uuid;
+	source->name = name;
+	source->settings = obs_data_create();
+	obs_data_set_string(source->settings, "text", "");
+
+	sources[uuid] = source;
+	return source;
+}
+
+void stub_destroy_sources()
+{
+	for (auto &source : sources)
+		obs_source_release(source.second);
+	sources.clear();
+}
+
+StubCounters stub_counters()
+{
+	return counters;
+}
+
+void stub_reset_counters()
+{
+	counters = StubCounters{};
+}
+
+obs_source_t *obs_get_source_by_uuid(const char *uuid)
+{
+	counters.source_lookups++;
+
+	auto it = sources.find(uuid);
+	if (it == sources.end())
+		return nullptr;
+
+	it->second->refs++;
+	return it->second;
+}
+
+obs_source_t *obs_source_get_ref(obs_source_t *source)
+{
+	if (source)
+		source->refs++;
+	return source;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+	if (!source || --source->refs)
+		return;
+
+	obs_data_release(source->settings);
+	delete source;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source->name.c_str();
+}
+
+const char *obs_source_get_uuid(const obs_source_t *source)
+{
+	return source->uuid.c_str();
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+obs_properties_t *obs_source_properties(const obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+
+	// like a real source, the property tree is built fresh on every call
+	counters.properties_built++;
+
+	obs_properties_t *props = new obs_properties;
+	props->props["text"] = obs_property{"text", OBS_PROPERTY_TEXT};
+	return props;
+}
+
+void obs_properties_destroy(obs_properties_t *props)
+{
+	delete props;
+}
+
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	UNUSED_PARAMETER(source);
+	UNUSED_PARAMETER(settings);
+	counters.source_updates++;
+}
+
+void obs_source_update_properties(obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+}
+
+obs_property_t *obs_properties_get(obs_properties_t *props,
+				   const char *property)
+{
+	if (!props)
+		return nullptr;
+
+	auto it = props->props.find(property);
+	return it == props->props.end() ? nullptr : &it->second;
+}
+
+enum obs_property_type obs_property_get_type(obs_property_t *p)
+{
+	return p ? p->type : OBS_PROPERTY_INVALID;
+}
+
+obs_properties_t *obs_property_group_content(obs_property_t *p)
+{
+	UNUSED_PARAMETER(p);
+	return nullptr;
+}
+
+const char *obs_property_name(obs_property_t *p)
+{
+	return p ? p->name.c_str() : "";
+}
+
+// every source counts as showing, so nothing is held back
+bool obs_source_showing(const obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+	return true;
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+	return nullptr;
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+			    signal_callback_t callback, void *data)
+{
+	UNUSED_PARAMETER(handler);
+	UNUSED_PARAMETER(signal);
+	UNUSED_PARAMETER(callback);
+	UNUSED_PARAMETER(data);
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+			       signal_callback_t callback, void *data)
+{
+	UNUSED_PARAMETER(handler);
+	UNUSED_PARAMETER(signal);
+	UNUSED_PARAMETER(callback);
+	UNUSED_PARAMETER(data);
+}
+
+bool calldata_get_data(const calldata_t *data, const char *name, void *out,
+		       size_t size)
+{
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(out);
+	UNUSED_PARAMETER(size);
+	return false;
+}
+
+/* the benchmark only uses property targets, so there are no scenes */
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+	UNUSED_PARAMETER(source);
+	return nullptr;
+}
+
+obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene, int64_t id)
+{
+	UNUSED_PARAMETER(scene);
+	UNUSED_PARAMETER(id);
+	return nullptr;
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t *item)
+{
+	UNUSED_PARAMETER(item);
+	return false;
+}
+
+bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
+{
+	UNUSED_PARAMETER(item);
+	UNUSED_PARAMETER(visible);
+	return false;
+}
+
+bool obs_get_video_info(struct obs_video_info *ovi)
+{
+	UNUSED_PARAMETER(ovi);
+	return false;
+}
+
+/* ------------------------------------------------------------------------- */
+/* utilities, config and frontend                                            */
+
+uint64_t os_gettime_ns(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+void blog(int log_level, const char *format, ...)
+{
+	if (log_level > LOG_WARNING)
+		return;
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+int astrcmpi(const char *str1, const char *str2)
+{
+	return strcasecmp(str1, str2);
+}
+
+const char *obs_module_text(const char *lookup_string)
+{
+	return lookup_string;
+}
+
+// no config directory, so there's no snapshot either
+obs_module_t *obs_current_module(void)
+{
+	return nullptr;
+}
+
+char *obs_module_get_config_path(obs_module_t *module, const char *file)
+{
+	UNUSED_PARAMETER(module);
+	UNUSED_PARAMETER(file);
+	return nullptr;
+}
+
+void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+// an empty global config, so the receiver starts from its defaults
+struct config_data {
+};
+
+static config_data globalConfig;
+
+config_t *obs_frontend_get_global_config(void)
+{
+	return &globalConfig;
+}
+
+void *obs_frontend_get_main_window(void)
+{
+	return nullptr;
+}
+
+// no scene collection, so the bindings are the shared list
+char *obs_frontend_get_current_scene_collection(void)
+{
+	return nullptr;
+}
+
+// never recording, so there's never a sidecar to write
+obs_output_t *obs_frontend_get_recording_output(void)
+{
+	return nullptr;
+}
+
+obs_data_t *obs_output_get_settings(const obs_output_t *output)
+{
+	UNUSED_PARAMETER(output);
+	return nullptr;
+}
+
+void obs_output_release(obs_output_t *output)
+{
+	UNUSED_PARAMETER(output);
+}
+
+size_t config_num_sections(config_t *config)
+{
+	UNUSED_PARAMETER(config);
+	return 0;
+}
+
+const char *config_get_section(config_t *config, size_t idx)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(idx);
+	return nullptr;
+}
+
+bool config_get_bool(config_t *config, const char *section, const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return false;
+}
+
+const char *config_get_string(config_t *config, const char *section,
+			      const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return nullptr;
+}
+
+uint64_t config_get_uint(config_t *config, const char *section,
+			 const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return 0;
+}
+
+int64_t config_get_int(config_t *config, const char *section, const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return 0;
+}
+
+bool config_has_user_value(config_t *config, const char *section,
+			   const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return false;
+}
+
+void config_set_int(config_t *config, const char *section, const char *name,
+		    int64_t value)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(value);
+}
+
+void config_set_bool(config_t *config, const char *section, const char *name,
+		     bool value)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(value);
+}
+
+void config_set_string(config_t *config, const char *section,
+		       const char *name, const char *value)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(value);
+}
+
+void config_set_uint(config_t *config, const char *section, const char *name,
+		     uint64_t value)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	UNUSED_PARAMETER(value);
+}
+
+bool config_remove_value(config_t *config, const char *section,
+			 const char *name)
+{
+	UNUSED_PARAMETER(config);
+	UNUSED_PARAMETER(section);
+	UNUSED_PARAMETER(name);
+	return false;
+}
+
+int config_save(config_t *config)
+{
+	UNUSED_PARAMETER(config);
+	return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef OBSSB_BENCH_OBS_STUBS_HPP
+#define OBSSB_BENCH_OBS_STUBS_HPP
+
+#include <obs.h>
+
+#include <cstdint>
+
+// Just enough of libobs and the frontend API for the receiver to run without
+// OBS. Sources are plain objects with a text property and a settings object;
+// updates only count themselves.
+
+obs_source_t *stub_create_source(const char *uuid, const char *name);
+void stub_destroy_sources();
+
+struct StubCounters {
+	unsigned long long source_updates;
+	unsigned long long source_lookups;
+	unsigned long long properties_built;
+};
+
+StubCounters stub_counters();
+void stub_reset_counters();
+
+#endif // OBSSB_BENCH_OBS_STUBS_HPP
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "clock.hpp"
+
+// a change bigger than this is someone setting the clock, not it running
+#define CLOCK_MAX_STEP_MS 2000
+
+ClockInterpolator::ClockInterpolator()
+{
+	valid = false;
+	tenths = false;
+	components = 1;
+	lead_digits = 1;
+	lead_zero = false;
+	value_ms = 0;
+	changed_ns = 0;
+	direction = 0;
+	shown_ms = 0;
+	shown_direction = 0;
+}
+
+bool ClockInterpolator::parse(const std::string_view &field, int64_t &ms,
+			      bool &hasTenths, int &fieldComponents,
+			      int &leadDigits, bool &leadZero) const
+{
+	int64_t parts[3] = {0, 0, 0};
+	int64_t frac = -1;
+	bool digits = false;
+	bool inFrac = false;
+
+	fieldComponents = 1;
+	leadDigits = 0;
+	leadZero = false;
+
+	for (char c : field) {
+		if (c == ' ') {
+			if (digits || inFrac)
+				break;
+			continue;
+		}
+
+		if (c >= '0' && c <= '9') {
+			if (inFrac) {
+				// only tenths are ever shown
+				if (frac < 0)
+					frac = c - '0';
+			} else {
+				parts[fieldComponents - 1] *= 10;
+				parts[fieldComponents - 1] += c - '0';
+				if (fieldComponents == 1 && !leadDigits++)
+					leadZero = c == '0';
+			}
+			digits = true;
+		} else if (c == ':' && !inFrac && fieldComponents < 3) {
+			fieldComponents++;
+		} else if (c == '.' && !inFrac) {
+			inFrac = true;
+		} else {
+			return false;
+		}
+	}
+
+	if (!digits)
+		return false;
+
+	int64_t seconds = 0;
+	for (int i = 0; i < fieldComponents; i++)
+		seconds = seconds * 60 + parts[i];
+
+	hasTenths = frac >= 0;
+	ms = seconds * 1000 + (hasTenths ? frac * 100 : 0);
+	leadDigits = std::max(leadDigits, 1);
+	leadZero = leadZero && leadDigits > 1;
+
+	return true;
+}
+
+void ClockInterpolator::sync(const std::string_view &field, uint64_t now_ns)
+{
+	if (valid && field == raw) {
+		// the same value well after it should have moved on: the clock
+		// has stopped, and the display goes back to the controller's
+		if (direction != 0 &&
+		    now_ns - changed_ns > (uint64_t)stepMs() * 3 / 2 * 1000000)
+			direction = 0;
+		return;
+	}
+
+	raw = field;
+
+	int64_t ms;
+	if (!parse(field, ms, tenths, components, lead_digits, lead_zero)) {
+		valid = false;
+		direction = 0;
+		shown_direction = 0;
+		return;
+	}
+
+	// the direction comes from successive values, and only small steps
+	// count - anything else stops the clock until it is seen moving again
+	int64_t delta = ms - value_ms;
+	if (valid && delta != 0 && delta <= CLOCK_MAX_STEP_MS &&
+	    delta >= -CLOCK_MAX_STEP_MS)
+		direction = delta < 0 ? -1 : 1;
+	else
+		direction = 0;
+
+	// a new run, so whatever was shown of the last one doesn't hold it
+	// back
+	if (direction != shown_direction)
+		shown_direction = 0;
+
+	valid = true;
+	value_ms = ms;
+	changed_ns = now_ns;
+}
+
+const std::string &ClockInterpolator::format(uint64_t now_ns)
+{
+	formatted = raw;
+	if (!valid || direction == 0)
+		return formatted;
+
+	int64_t step = stepMs();
+	int64_t elapsed = (int64_t)((now_ns - changed_ns) / 1000000);
+
+	// a running clock changes every step, so if nothing has arrived for a
+	// couple of them it has stopped, and the controller's value stands
+	if (elapsed > step * 5 / 2) {
+		direction = 0;
+		return formatted;
+	}
+
+	// run at most one step ahead of the controller; the next frame puts us
+	// back in sync either way
+	int64_t ms = value_ms + direction * std::min(elapsed, step);
+
+	// round so the step lands at the same moment the controller's would
+	if (direction < 0)
+		ms = (ms + step - 1) / step * step;
+	else
+		ms = ms / step * step;
+
+	// never behind what's been shown already, e.g. when a frame that
+	// was sent before it arrives
+	if (shown_direction == direction && (ms - shown_ms) * direction < 0)
+		ms = shown_ms;
+	shown_ms = ms;
+	shown_direction = direction;
+
+	if (ms == value_ms)
+		return formatted;
+	if (ms < 0)
+		ms = 0;
+
+	int64_t seconds = ms / 1000;
+	char buf[32];
+	int len;
+
+	long long lead = components == 3   ? seconds / 3600
+			 : components == 2 ? seconds / 60
+					   : seconds;
+
+	// padded the way the controller pads the field now, so " 9:59"
+	// follows "10:00" unless the controller zero-pads
+	if (lead_zero)
+		len = snprintf(buf, sizeof(buf), "%0*lld", lead_digits, lead);
+	else
+		len = snprintf(buf, sizeof(buf), "%*lld", lead_digits, lead);
+
+	if (components == 3 && len > 0 && len < (int)sizeof(buf))
+		len += snprintf(buf + len, sizeof(buf) - len, ":%02lld:%02lld",
+				(long long)(seconds / 60 % 60),
+				(long long)(seconds % 60));
+	else if (components == 2 && len > 0 && len < (int)sizeof(buf))
+		len += snprintf(buf + len, sizeof(buf) - len, ":%02lld",
+				(long long)(seconds % 60));
+
+	if (tenths && len > 0 && len < (int)sizeof(buf))
+		len += snprintf(buf + len, sizeof(buf) - len, ".%lld",
+				(long long)(ms % 1000 / 100));
+
+	if (len <= 0)
+		return formatted;
+
+	// right-justify into the original field, like the controller does
+	std::string_view text(buf, std::min<size_t>(len, sizeof(buf) - 1));
+	if (text.size() < raw.size())
+		formatted.assign(raw.size() - text.size(), ' ');
+	else
+		formatted.clear();
+	formatted += text;
+
+	return formatted;
+}
@@ -0,0 +1,50 @@
+#ifndef OBSSB_CLOCK_HPP
+#define OBSSB_CLOCK_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Tracks a clock field as it arrives from the controller and works out where
+// it should be in between updates, so a countdown moves at a steady rate no
+// matter how unevenly the packets show up.
+class ClockInterpolator {
+public:
+	ClockInterpolator();
+
+	// feed the raw field whenever it is read from the score table
+	void sync(const std::string_view &field, uint64_t now_ns);
+
+	// the field as it should look at now_ns, right-justified to the width
+	// it arrived with. Fields that don't parse as a clock pass through.
+	const std::string &format(uint64_t now_ns);
+
+	inline bool isRunning() const { return direction != 0; }
+
+private:
+	bool parse(const std::string_view &field, int64_t &ms, bool &hasTenths,
+		   int &fieldComponents, int &leadDigits, bool &leadZero) const;
+
+	std::string raw;
+	std::string formatted;
+
+	// the shape of the field, so it can be reproduced when formatting
+	bool valid;
+	bool tenths;
+	int components;
+	int lead_digits;
+	bool lead_zero;
+
+	int64_t value_ms;
+	uint64_t changed_ns;
+	int direction;
+
+	// what's last been shown of the current run, which the display never
+	// goes back on while it's running
+	int64_t shown_ms;
+	int shown_direction;
+
+	inline int64_t stepMs() const { return tenths ? 100 : 1000; }
+};
+
+#endif // OBSSB_CLOCK_HPP
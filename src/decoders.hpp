@@ -0,0 +1,218 @@
+#ifndef OBSSB_DECODERS_HPP
+#define OBSSB_DECODERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "trace.hpp"
+
+// Decoders turn datagrams from a console into writes to the score table.
+// Each one is a struct with a static decode() templated on its sink: the
+// receiver picks a decoder once per datagram, and the loop over the bytes is
+// compiled for that protocol and that sink with nothing virtual in between.
+//
+// A sink provides:
+//
+//   const char *write(size_t offset, const std::string_view &data);
+//   void frame();
+//   void error(const char *reason, const std::string_view &raw);
+//
+// write() returns why the sink turned the data away, which drops the update.
+// frame() or error() ends every update, after whatever it wrote. Offsets are
+// zero-based, and the data points into the datagram.
+
+#define RTD_SYN '\x16'
+#define RTD_SOH '\x01'
+#define RTD_STX '\x02'
+#define RTD_EOT '\x04'
+#define RTD_ETB '\x17'
+
+#define RTD_IS_CONTROL_CHAR(c) (c < 0x20)
+
+// Daktronics real-time data, as sent by the AllSport 5000:
+//
+//   SYN | SOH | offset digits | STX | body | EOT | checksum hex | ETB
+template <bool ValidateChecksums> struct RtdDecoder {
+	template <typename Sink>
+	static void decode(const std::string_view &data, Sink &sink)
+	{
+		size_t begin = 0;
+
+		for (size_t i = 0; i < data.size(); i++) {
+			switch (data[i]) {
+			case RTD_SYN:
+				begin = i;
+				break;
+			case RTD_ETB:
+				std::string_view frame =
+					data.substr(begin, i - begin);
+				const char *error = decodeFrame(frame, sink);
+				if (error)
+					sink.error(error, frame);
+				else
+					sink.frame();
+				break;
+			}
+		}
+	}
+
+	template <typename Sink>
+	static const char *decodeFrame(const std::string_view &frame,
+				       Sink &sink)
+	{
+		TRACE_ZONE("processFrame");
+
+		enum { NONE, SYNC, HEAD, BODY, CHECKSUM } section = NONE;
+
+		size_t offset = 0;
+		uint8_t calculatedChecksum = 0, receivedChecksum = 0;
+		size_t bodyStart = 0, bodyEnd = frame.size();
+
+		for (size_t i = 0; i < frame.size(); i++) {
+			char c = frame[i];
+
+			if (section != NONE && section != CHECKSUM)
+				calculatedChecksum += c;
+
+			if (RTD_IS_CONTROL_CHAR(c)) {
+				// advance the section in lock-step by control
+				// characters, and drop the frame if anything
+				// unexpected happens
+				switch (c) {
+				case RTD_SYN:
+					if (section != NONE)
+						return "unexpected SYN";
+					section = SYNC;
+					break;
+				case RTD_SOH:
+					if (section != SYNC)
+						return "unexpected SOH";
+					section = HEAD;
+					break;
+				case RTD_STX:
+					if (section != HEAD)
+						return "unexpected STX";
+					section = BODY;
+					bodyStart = i + 1;
+					break;
+				case RTD_EOT:
+					// the AS5000 sends frames with no
+					// body from time to time, for reasons
+					// unknown. They aren't errors, so
+					// they don't get logged or counted.
+					if (section != BODY)
+						return nullptr;
+					section = CHECKSUM;
+					bodyEnd = i;
+					break;
+				default:
+					return "illegal control character";
+				}
+				continue;
+			}
+
+			switch (section) {
+			case NONE:
+				return "data outside of frame";
+			case SYNC:
+				// keeps the current loop in sync
+				break;
+			case HEAD:
+				if (c < '0' || c > '9')
+					return "non-digit in offset field";
+
+				offset *= 10;
+				offset += c - '0';
+				offset %= 100000;
+				break;
+			case BODY:
+				// only the bounds of the body are kept
+				break;
+			case CHECKSUM:
+				receivedChecksum <<= 4;
+
+				if (c >= '0' && c <= '9')
+					receivedChecksum += c - '0';
+				else if (c >= 'A' && c <= 'F')
+					receivedChecksum += c - 'A' + 0xA;
+				else
+					return "non-hex character in checksum "
+					       "field";
+				break;
+			}
+		}
+
+		if (section != CHECKSUM)
+			return "unexpected end of frame";
+
+		if (ValidateChecksums && calculatedChecksum != receivedChecksum)
+			return "invalid checksum";
+
+		return sink.write(offset,
+				  frame.substr(bodyStart, bodyEnd - bodyStart));
+	}
+};
+
+// same range as an RTD offset
+#define LINE_MAX_ITEM 100000
+
+// Plain text from consoles that print one update per line, usually through
+// a serial-to-UDP bridge:
+//
+//   item number | ':' or '=' | text | CR and/or LF
+//
+// the item number is the one bindings use, counting from 1, and the text is
+// written there as it is. A datagram can carry any number of lines, but a
+// line can't be split across datagrams.
+struct LineDecoder {
+	template <typename Sink>
+	static void decode(const std::string_view &data, Sink &sink)
+	{
+		size_t pos = 0;
+
+		while (pos < data.size()) {
+			size_t end = data.find_first_of("\r\n", pos);
+			if (end == std::string_view::npos)
+				end = data.size();
+
+			std::string_view line = data.substr(pos, end - pos);
+			pos = end + 1;
+
+			if (line.empty())
+				continue;
+
+			const char *error = decodeLine(line, sink);
+			if (error)
+				sink.error(error, line);
+			else
+				sink.frame();
+		}
+	}
+
+	template <typename Sink>
+	static const char *decodeLine(const std::string_view &line, Sink &sink)
+	{
+		TRACE_ZONE("processLine");
+
+		size_t item = 0, i = 0;
+
+		for (; i < line.size(); i++) {
+			if (line[i] < '0' || line[i] > '9')
+				break;
+
+			item = item * 10 + (line[i] - '0');
+			if (item > LINE_MAX_ITEM)
+				return "item number out of range";
+		}
+
+		if (i == 0 || item == 0)
+			return "missing item number";
+		if (i == line.size() || (line[i] != ':' && line[i] != '='))
+			return "missing separator";
+
+		return sink.write(item - 1, line.substr(i + 1));
+	}
+};
+
+#endif // OBSSB_DECODERS_HPP
@@ -0,0 +1,795 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "derived.hpp"
+#include "score-table.hpp"
+
+// how deeply expressions may nest, so evaluating one can't run out of stack
+#define DERIVED_MAX_DEPTH 64
+
+#define OP_NUMBER 0
+#define OP_TEXT 1
+#define OP_FIELD 2
+#define OP_NOT 3
+#define OP_NEGATE 4
+#define OP_ADD 5
+#define OP_SUBTRACT 6
+#define OP_MULTIPLY 7
+#define OP_DIVIDE 8
+#define OP_MODULO 9
+#define OP_EQUAL 10
+#define OP_NOT_EQUAL 11
+#define OP_LESS 12
+#define OP_LESS_EQUAL 13
+#define OP_GREATER 14
+#define OP_GREATER_EQUAL 15
+#define OP_AND 16
+#define OP_OR 17
+#define OP_CONDITION 18
+#define OP_ABS 19
+#define OP_MIN 20
+#define OP_MAX 21
+#define OP_TRIM 22
+
+typedef DerivedFields::Node Node;
+
+static std::string_view trimmed(std::string_view text)
+{
+	size_t first = text.find_first_not_of(" \t\r");
+	if (first == std::string_view::npos)
+		return std::string_view();
+
+	size_t last = text.find_last_not_of(" \t\r");
+	return text.substr(first, last - first + 1);
+}
+
+// numbers, and clocks as m:ss or h:mm:ss with optional tenths, in seconds
+static bool parseNumber(std::string_view text, double &out)
+{
+	text = trimmed(text);
+
+	bool negative = !text.empty() && text[0] == '-';
+	if (negative)
+		text.remove_prefix(1);
+
+	double value = 0, part = 0, scale = 0;
+	bool digits = false;
+	int components = 1;
+
+	for (char c : text) {
+		if (c >= '0' && c <= '9') {
+			if (scale) {
+				part += (c - '0') * scale;
+				scale /= 10;
+			} else {
+				part = part * 10 + (c - '0');
+			}
+			digits = true;
+		} else if (c == ':' && !scale && digits && components < 3) {
+			value = (value + part) * 60;
+			part = 0;
+			digits = false;
+			components++;
+		} else if (c == '.' && !scale) {
+			scale = 0.1;
+		} else {
+			return false;
+		}
+	}
+
+	if (!digits)
+		return false;
+
+	out = negative ? -(value + part) : value + part;
+	return true;
+}
+
+static std::string formatNumber(double number)
+{
+	char buf[64];
+
+	// tenths are as fine as anything on a scoreboard goes
+	if (std::fabs(number) < 1e15 && number == std::floor(number))
+		snprintf(buf, sizeof(buf), "%.0f", number);
+	else
+		snprintf(buf, sizeof(buf), "%.1f", number);
+
+	return buf;
+}
+
+struct Value {
+	bool isNumber;
+	double number;
+	std::string text;
+};
+
+static inline Value numberValue(double number)
+{
+	return {true, number, std::string()};
+}
+
+static inline Value textValue(std::string text)
+{
+	return {false, 0, std::move(text)};
+}
+
+static bool asNumber(const Value &value, double &out)
+{
+	if (value.isNumber) {
+		out = value.number;
+		return true;
+	}
+	return parseNumber(value.text, out);
+}
+
+static double numberOf(const Value &value)
+{
+	double number;
+	return asNumber(value, number) ? number : 0;
+}
+
+static std::string textOf(const Value &value)
+{
+	return value.isNumber ? formatNumber(value.number) : value.text;
+}
+
+// blank is false, the same as bindings treat it
+static bool truthy(const Value &value)
+{
+	if (value.isNumber)
+		return value.number != 0;
+	return !trimmed(value.text).empty();
+}
+
+static int compareValues(const Value &a, const Value &b)
+{
+	double x, y;
+	if (asNumber(a, x) && asNumber(b, y))
+		return (x > y) - (x < y);
+
+	std::string left = textOf(a), right = textOf(b);
+	int result = trimmed(left).compare(trimmed(right));
+	return (result > 0) - (result < 0);
+}
+
+static Value evaluateNode(const std::vector<Node> &nodes, int index,
+			  const ScoreTable &table)
+{
+	const Node &node = nodes[index];
+	auto arg = [&](int i) {
+		return evaluateNode(nodes, node.args[i], table);
+	};
+
+	switch (node.op) {
+	case OP_NUMBER:
+		return numberValue(node.number);
+	case OP_TEXT:
+		return textValue(node.text);
+	case OP_FIELD:
+		// past the end of a table that's shrunk is as good as blank
+		if (!table.contains(node.offset, node.length))
+			return textValue(std::string());
+		return textValue(
+			std::string(table.range(node.offset, node.length)));
+	case OP_NOT:
+		return numberValue(!truthy(arg(0)));
+	case OP_NEGATE:
+		return numberValue(-numberOf(arg(0)));
+	case OP_ADD: {
+		Value a = arg(0), b = arg(1);
+		double x, y;
+		if (asNumber(a, x) && asNumber(b, y))
+			return numberValue(x + y);
+		return textValue(textOf(a) + textOf(b));
+	}
+	case OP_SUBTRACT:
+		return numberValue(numberOf(arg(0)) - numberOf(arg(1)));
+	case OP_MULTIPLY:
+		return numberValue(numberOf(arg(0)) * numberOf(arg(1)));
+	case OP_DIVIDE:
+	case OP_MODULO: {
+		double x = numberOf(arg(0)), y = numberOf(arg(1));
+
+		// a field that's still blank shouldn't make a mess of things
+		if (y == 0)
+			return numberValue(0);
+		return numberValue(node.op == OP_DIVIDE ? x / y
+							: std::fmod(x, y));
+	}
+	case OP_EQUAL:
+		return numberValue(compareValues(arg(0), arg(1)) == 0);
+	case OP_NOT_EQUAL:
+		return numberValue(compareValues(arg(0), arg(1)) != 0);
+	case OP_LESS:
+		return numberValue(compareValues(arg(0), arg(1)) < 0);
+	case OP_LESS_EQUAL:
+		return numberValue(compareValues(arg(0), arg(1)) <= 0);
+	case OP_GREATER:
+		return numberValue(compareValues(arg(0), arg(1)) > 0);
+	case OP_GREATER_EQUAL:
+		return numberValue(compareValues(arg(0), arg(1)) >= 0);
+	case OP_AND:
+		return numberValue(truthy(arg(0)) && truthy(arg(1)));
+	case OP_OR:
+		return numberValue(truthy(arg(0)) || truthy(arg(1)));
+	case OP_CONDITION:
+		return truthy(arg(0)) ? arg(1) : arg(2);
+	case OP_ABS:
+		return numberValue(std::fabs(numberOf(arg(0))));
+	case OP_MIN:
+	case OP_MAX: {
+		Value a = arg(0), b = arg(1);
+		bool less = compareValues(a, b) < 0;
+		return less == (node.op == OP_MIN) ? a : b;
+	}
+	case OP_TRIM:
+		return textValue(std::string(trimmed(textOf(arg(0)))));
+	}
+
+	return textValue(std::string());
+}
+
+// numbers line up on the right like the console's own, text on the left
+static std::string formatValue(const Value &value, size_t length)
+{
+	std::string text = textOf(value);
+	if (text.size() >= length)
+		return text.substr(0, length);
+
+	std::string padding(length - text.size(), ' ');
+	return value.isNumber ? padding + text : text + padding;
+}
+
+// Recursive descent over one expression, lowest precedence first. Nodes go
+// straight into the shared list, and the fields it reads into inputs.
+class DerivedParser {
+public:
+	// column is where the expression starts on its line, for errors
+	DerivedParser(std::vector<Node> &nodes_, std::string_view text_,
+		      size_t column_,
+		      std::vector<std::pair<size_t, size_t>> &inputs_)
+		: nodes(nodes_), text(text_), inputs(inputs_)
+	{
+		column = column_;
+		pos = 0;
+		depth = 0;
+	}
+
+	int parse(std::string &message)
+	{
+		int root = condition();
+		skipSpace();
+		if (root >= 0 && pos < text.size())
+			root = fail("unexpected '" + std::string(1, text[pos]) +
+				    "'");
+
+		message = error;
+		return root;
+	}
+
+private:
+	std::vector<Node> &nodes;
+	std::string_view text;
+	std::vector<std::pair<size_t, size_t>> &inputs;
+	size_t column;
+	size_t pos;
+	int depth;
+	std::string error;
+
+	int fail(const std::string &message)
+	{
+		if (error.empty())
+			error = message + " at column " +
+				std::to_string(column + pos + 1);
+		return -1;
+	}
+
+	void skipSpace()
+	{
+		while (pos < text.size() && (text[pos] == ' ' ||
+					     text[pos] == '\t' ||
+					     text[pos] == '\r'))
+			pos++;
+	}
+
+	bool accept(std::string_view token)
+	{
+		skipSpace();
+		if (text.substr(pos, token.size()) != token)
+			return false;
+
+		pos += token.size();
+		return true;
+	}
+
+	int add(int op, int a = -1, int b = -1, int c = -1)
+	{
+		Node node = {op, 0, std::string(), 0, 0, {a, b, c}};
+		nodes.push_back(node);
+		return (int)nodes.size() - 1;
+	}
+
+	int condition()
+	{
+		if (++depth > DERIVED_MAX_DEPTH)
+			return fail("expression nested too deeply");
+
+		int result = logicalOr();
+		if (result >= 0 && accept("?")) {
+			int a = condition();
+			if (a < 0)
+				return -1;
+			if (!accept(":"))
+				return fail("expected ':'");
+			int b = condition();
+			if (b < 0)
+				return -1;
+			result = add(OP_CONDITION, result, a, b);
+		}
+
+		depth--;
+		return result;
+	}
+
+	int logicalOr()
+	{
+		int result = logicalAnd();
+		while (result >= 0 && accept("||")) {
+			int b = logicalAnd();
+			result = b < 0 ? -1 : add(OP_OR, result, b);
+		}
+		return result;
+	}
+
+	int logicalAnd()
+	{
+		int result = comparison();
+		while (result >= 0 && accept("&&")) {
+			int b = comparison();
+			result = b < 0 ? -1 : add(OP_AND, result, b);
+		}
+		return result;
+	}
+
+	int comparison()
+	{
+		// longer tokens first, so <= isn't taken for <
+		static const struct {
+			const char *token;
+			int op;
+		} ops[] = {{"==", OP_EQUAL},	  {"!=", OP_NOT_EQUAL},
+			   {"<=", OP_LESS_EQUAL}, {">=", OP_GREATER_EQUAL},
+			   {"<", OP_LESS},	  {">", OP_GREATER}};
+
+		int result = additive();
+		if (result < 0)
+			return -1;
+
+		for (auto &op : ops) {
+			if (!accept(op.token))
+				continue;
+
+			int b = additive();
+			return b < 0 ? -1 : add(op.op, result, b);
+		}
+		return result;
+	}
+
+	int additive()
+	{
+		int result = multiplicative();
+		while (result >= 0) {
+			int op;
+			if (accept("+"))
+				op = OP_ADD;
+			else if (accept("-"))
+				op = OP_SUBTRACT;
+			else
+				break;
+
+			int b = multiplicative();
+			result = b < 0 ? -1 : add(op, result, b);
+		}
+		return result;
+	}
+
+	int multiplicative()
+	{
+		int result = unary();
+		while (result >= 0) {
+			int op;
+			if (accept("*"))
+				op = OP_MULTIPLY;
+			else if (accept("/"))
+				op = OP_DIVIDE;
+			else if (accept("%"))
+				op = OP_MODULO;
+			else
+				break;
+
+			int b = unary();
+			result = b < 0 ? -1 : add(op, result, b);
+		}
+		return result;
+	}
+
+	int unary()
+	{
+		if (++depth > DERIVED_MAX_DEPTH)
+			return fail("expression nested too deeply");
+
+		int result;
+		if (accept("!")) {
+			int a = unary();
+			result = a < 0 ? -1 : add(OP_NOT, a);
+		} else if (accept("-")) {
+			int a = unary();
+			result = a < 0 ? -1 : add(OP_NEGATE, a);
+		} else {
+			result = primary();
+		}
+
+		depth--;
+		return result;
+	}
+
+	bool unsignedNumber(size_t &value)
+	{
+		skipSpace();
+		size_t start = pos;
+
+		value = 0;
+		while (pos < text.size() && text[pos] >= '0' &&
+		       text[pos] <= '9' && value <= SCORE_TABLE_MAX_CAPACITY)
+			value = value * 10 + (text[pos++] - '0');
+
+		return pos > start;
+	}
+
+	int field()
+	{
+		size_t item, length = 1;
+		if (!unsignedNumber(item))
+			return fail("expected an item number");
+		if (accept(":") && !unsignedNumber(length))
+			return fail("expected a length");
+		if (!accept("]"))
+			return fail("expected ']'");
+
+		if (item < 1 || length < 1 || length > DERIVED_MAX_LENGTH ||
+		    item - 1 > SCORE_TABLE_MAX_CAPACITY - length)
+			return fail("field out of range");
+
+		int result = add(OP_FIELD);
+		nodes[result].offset = item - 1;
+		nodes[result].length = length;
+		inputs.emplace_back(item - 1, item - 1 + length);
+		return result;
+	}
+
+	int function(const std::string &name)
+	{
+		static const struct {
+			const char *name;
+			int op;
+			int args;
+		} functions[] = {{"abs", OP_ABS, 1},
+				 {"min", OP_MIN, 2},
+				 {"max", OP_MAX, 2},
+				 {"trim", OP_TRIM, 1}};
+
+		for (auto &function : functions) {
+			if (name != function.name)
+				continue;
+
+			if (!accept("("))
+				return fail("expected '('");
+
+			int args[2] = {-1, -1};
+			for (int i = 0; i < function.args; i++) {
+				if (i > 0 && !accept(","))
+					return fail("expected ','");
+				args[i] = condition();
+				if (args[i] < 0)
+					return -1;
+			}
+
+			if (!accept(")"))
+				return fail("expected ')'");
+			return add(function.op, args[0], args[1]);
+		}
+
+		return fail("unknown function '" + name + "'");
+	}
+
+	int primary()
+	{
+		skipSpace();
+		if (pos >= text.size())
+			return fail("expected a value");
+
+		char c = text[pos];
+
+		if (accept("(")) {
+			int result = condition();
+			if (result >= 0 && !accept(")"))
+				return fail("expected ')'");
+			return result;
+		}
+
+		if (accept("["))
+			return field();
+
+		if (c == '"') {
+			size_t end = text.find('"', pos + 1);
+			if (end == std::string_view::npos)
+				return fail("unterminated text");
+
+			int result = add(OP_TEXT);
+			nodes[result].text =
+				text.substr(pos + 1, end - pos - 1);
+			pos = end + 1;
+			return result;
+		}
+
+		if ((c >= '0' && c <= '9') || c == '.') {
+			size_t end = pos;
+			while (end < text.size() &&
+			       ((text[end] >= '0' && text[end] <= '9') ||
+				text[end] == '.'))
+				end++;
+
+			double number;
+			if (!parseNumber(text.substr(pos, end - pos), number))
+				return fail("invalid number");
+
+			int result = add(OP_NUMBER);
+			nodes[result].number = number;
+			pos = end;
+			return result;
+		}
+
+		if (c >= 'a' && c <= 'z') {
+			size_t end = pos;
+			while (end < text.size() && text[end] >= 'a' &&
+			       text[end] <= 'z')
+				end++;
+
+			std::string name(text.substr(pos, end - pos));
+			pos = end;
+			return function(name);
+		}
+
+		return fail("unexpected '" + std::string(1, c) + "'");
+	}
+};
+
+static inline bool overlaps(size_t beginA, size_t endA, size_t beginB,
+			    size_t endB)
+{
+	return beginA < endB && beginB < endA;
+}
+
+DerivedFields::DerivedFields()
+{
+	longestSpan = 0;
+	anyDirty = false;
+}
+
+bool DerivedFields::compile(const std::string &text, std::string &error)
+{
+	std::vector<Field> parsed;
+	std::vector<Node> parsedNodes;
+
+	auto lineError = [&](int line, const std::string &message) {
+		error = "line " + std::to_string(line) + ": " + message;
+		return false;
+	};
+
+	int line = 0;
+	for (size_t start = 0; start <= text.size();) {
+		size_t end = text.find('\n', start);
+		if (end == std::string::npos)
+			end = text.size();
+
+		std::string_view definition = trimmed(
+			std::string_view(text).substr(start, end - start));
+		start = end + 1;
+		line++;
+
+		if (definition.empty() || definition[0] == '#')
+			continue;
+
+		size_t equals = definition.find('=');
+		if (equals == std::string_view::npos)
+			return lineError(line, "expected <item>:<length> =");
+
+		// the field written to, as item:length
+		unsigned item = 0, length = 0;
+		int used = 0;
+		std::string head(trimmed(definition.substr(0, equals)));
+		if (sscanf(head.c_str(), "%u:%u%n", &item, &length, &used) !=
+			    2 ||
+		    used != (int)head.size())
+			return lineError(line, "expected <item>:<length> =");
+
+		if (item < 1 || length < 1 || length > DERIVED_MAX_LENGTH ||
+		    item - 1 > SCORE_TABLE_MAX_CAPACITY - length)
+			return lineError(line, "field out of range");
+
+		Field field;
+		field.offset = item - 1;
+		field.length = length;
+		field.line = line;
+		field.dirty = true;
+
+		std::string message;
+		DerivedParser parser(parsedNodes, definition.substr(equals + 1),
+				     equals + 1, field.inputs);
+		field.root = parser.parse(message);
+		if (field.root < 0)
+			return lineError(line, message);
+
+		parsed.push_back(std::move(field));
+	}
+
+	// two definitions writing to the same place would fight over it
+	for (size_t i = 0; i < parsed.size(); i++) {
+		for (size_t j = 0; j < i; j++) {
+			if (overlaps(parsed[i].offset,
+				     parsed[i].offset + parsed[i].length,
+				     parsed[j].offset,
+				     parsed[j].offset + parsed[j].length))
+				return lineError(
+					parsed[i].line,
+					"overlaps the field on line " +
+						std::to_string(parsed[j].line));
+		}
+	}
+
+	// readers[i] are the definitions that read what i writes
+	std::vector<std::vector<size_t>> readers(parsed.size());
+	std::vector<size_t> waitingOn(parsed.size(), 0);
+	for (size_t i = 0; i < parsed.size(); i++) {
+		size_t begin = parsed[i].offset;
+		size_t end = begin + parsed[i].length;
+
+		for (size_t j = 0; j < parsed.size(); j++) {
+			for (auto &input : parsed[j].inputs) {
+				if (!overlaps(begin, end, input.first,
+					      input.second))
+					continue;
+
+				if (i == j)
+					return lineError(parsed[i].line,
+							 "reads its own field");
+
+				readers[i].push_back(j);
+				waitingOn[j]++;
+				break;
+			}
+		}
+	}
+
+	// in definition order as far as the dependencies allow
+	std::vector<size_t> order, position(parsed.size());
+	std::vector<bool> placed(parsed.size(), false);
+	while (order.size() < parsed.size()) {
+		size_t next = parsed.size();
+		for (size_t i = 0; i < parsed.size(); i++) {
+			if (!placed[i] && !waitingOn[i]) {
+				next = i;
+				break;
+			}
+		}
+
+		if (next == parsed.size()) {
+			for (size_t i = 0; i < parsed.size(); i++) {
+				if (!placed[i])
+					return lineError(
+						parsed[i].line,
+						"depends on itself through "
+						"other fields");
+			}
+		}
+
+		placed[next] = true;
+		position[next] = order.size();
+		order.push_back(next);
+		for (size_t reader : readers[next])
+			waitingOn[reader]--;
+	}
+
+	std::vector<Field> sorted;
+	for (size_t i : order) {
+		sorted.push_back(std::move(parsed[i]));
+		for (size_t reader : readers[i])
+			sorted.back().dependents.push_back(position[reader]);
+	}
+
+	fields.swap(sorted);
+	nodes.swap(parsedNodes);
+
+	spans.clear();
+	longestSpan = 0;
+	for (size_t i = 0; i < fields.size(); i++) {
+		for (auto &input : fields[i].inputs) {
+			spans.push_back({input.first, input.second, i});
+			longestSpan = std::max(longestSpan,
+					       input.second - input.first);
+		}
+	}
+
+	std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) {
+		return a.begin < b.begin;
+	});
+
+	anyDirty = !fields.empty();
+	error.clear();
+	return true;
+}
+
+size_t DerivedFields::extent() const
+{
+	size_t end = 0;
+	for (auto &field : fields)
+		end = std::max(end, field.offset + field.length);
+	return end;
+}
+
+void DerivedFields::markDirty(size_t offset, size_t length)
+{
+	if (spans.empty())
+		return;
+
+	// nothing that starts further back than the longest input can reach
+	size_t from = offset > longestSpan ? offset - longestSpan : 0;
+	auto it = std::lower_bound(spans.begin(), spans.end(), from,
+				   [](const Span &span, size_t value) {
+					   return span.begin < value;
+				   });
+
+	for (; it != spans.end() && it->begin < offset + length; it++) {
+		if (it->end > offset) {
+			fields[it->field].dirty = true;
+			anyDirty = true;
+		}
+	}
+}
+
+void DerivedFields::markAll()
+{
+	for (auto &field : fields)
+		field.dirty = true;
+	anyDirty = !fields.empty();
+}
+
+size_t DerivedFields::evaluate(const ScoreTable &table, const Writer &write)
+{
+	if (!anyDirty)
+		return 0;
+	anyDirty = false;
+
+	size_t written = 0;
+
+	// whatever a field feeds comes after it, so one pass is enough
+	for (auto &field : fields) {
+		if (!field.dirty)
+			continue;
+		field.dirty = false;
+
+		if (!table.contains(field.offset, field.length))
+			continue;
+
+		Value value = evaluateNode(nodes, field.root, table);
+		if (!write(field.offset, formatValue(value, field.length)))
+			continue;
+
+		written++;
+		for (size_t dependent : field.dependents)
+			fields[dependent].dirty = true;
+	}
+
+	return written;
+}
@@ -0,0 +1,102 @@
+#ifndef OBSSB_DERIVED_HPP
+#define OBSSB_DERIVED_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ScoreTable;
+
+// the longest field a derived value can be written to
+#define DERIVED_MAX_LENGTH 1024
+
+// Fields worked out from other fields and written back into the score table,
+// so bindings, text sources and the relay take them like any other. Each is
+// defined on a line of its own:
+//
+//     <item>:<length> = <expression>
+//
+// Expressions read the table as [item:length], or [item] for one character,
+// and have numbers, "text", + - * / %, comparisons, && || !, a ? b : c, and
+// abs(), min(), max() and trim(). Fields that read as numbers or clocks
+// (m:ss, m:ss.t, in seconds) are used as numbers, anything else as text, and
+// blank is false. + joins text together. Lines starting with # are ignored.
+//
+// Definitions that read what others write are evaluated after them, and only
+// the ones downstream of a change are evaluated at all.
+class DerivedFields {
+public:
+	DerivedFields();
+
+	// replaces the definitions. Nothing changes if they don't compile, and
+	// error says what's wrong and on which line.
+	bool compile(const std::string &text, std::string &error);
+
+	inline bool empty() const { return fields.empty(); }
+
+	// how far into the table the derived fields are written
+	size_t extent() const;
+
+	// [offset, offset + length) of the table has changed
+	void markDirty(size_t offset, size_t length);
+
+	// everything is evaluated again, e.g. when the table has been resized
+	void markAll();
+
+	// stores a derived value, and says whether that changed the table
+	typedef std::function<bool(size_t offset,
+				   const std::string_view &value)>
+		Writer;
+
+	// evaluates everything affected by the changes marked since last
+	// time, in dependency order; returns how many fields were written
+	size_t evaluate(const ScoreTable &table, const Writer &write);
+
+	// one step of a compiled expression, see derived.cpp
+	struct Node {
+		int op;
+		double number;
+		std::string text;
+		size_t offset;
+		size_t length;
+
+		// operands, as indexes into the node list
+		int args[3];
+	};
+
+private:
+	struct Field {
+		size_t offset;
+		size_t length;
+		int root;
+		int line;
+
+		// ranges of the table the expression reads
+		std::vector<std::pair<size_t, size_t>> inputs;
+
+		// fields that read this one, all later in evaluation order
+		std::vector<size_t> dependents;
+
+		bool dirty;
+	};
+
+	// fields in evaluation order, and the nodes of all their expressions
+	std::vector<Field> fields;
+	std::vector<Node> nodes;
+
+	// every input range, sorted by where it starts, to find which fields a
+	// change reaches
+	struct Span {
+		size_t begin;
+		size_t end;
+		size_t field;
+	};
+	std::vector<Span> spans;
+	size_t longestSpan;
+
+	bool anyDirty;
+};
+
+#endif // OBSSB_DERIVED_HPP
@@ -0,0 +1,322 @@
+#include <obs.hpp>
+
+#include <algorithm>
+
+#include "binding-model.hpp"
+#include "../receiver.hpp"
+
+#include "../plugin-macros.generated.h"
+
+extern Receiver *receiver;
+
+// the most a busy feed gets the view repainted, in milliseconds
+#define REFRESH_INTERVAL 250
+
+BindingModel::BindingModel(QObject *parent) : QAbstractTableModel(parent)
+{
+	longestSpan = 0;
+	set = receiver->getBindings();
+
+	changes = new TableChanges(REFRESH_INTERVAL, this);
+	connect(changes, &TableChanges::due, this,
+		&BindingModel::flushChanges);
+}
+
+int BindingModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)set->bindings.size();
+}
+
+int BindingModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return ColumnCount;
+}
+
+QVariant BindingModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= rowCount())
+		return QVariant();
+
+	const Binding &binding = *set->bindings[index.row()];
+
+	if (role == Qt::EditRole && index.column() == NameColumn)
+		return QString::fromStdString(binding.name);
+
+	if (role == Qt::CheckStateRole && index.column() == NameColumn)
+		return binding.enabled ? Qt::Checked : Qt::Unchecked;
+
+	if (role != Qt::DisplayRole)
+		return QVariant();
+
+	switch (index.column()) {
+	case NameColumn:
+		return QString::fromStdString(binding.name);
+	case OffsetColumn:
+		return binding.item_number;
+	case LengthColumn:
+		return binding.field_length;
+	case TargetColumn:
+		// only cached for the rows laid out so far
+		if ((size_t)index.row() < targets.size())
+			return targets[index.row()];
+		return describeTarget(binding);
+	case ValueColumn:
+		return describeValue(binding);
+	}
+
+	return QVariant();
+}
+
+QVariant BindingModel::headerData(int section, Qt::Orientation orientation,
+				  int role) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+		return QVariant();
+
+	switch (section) {
+	case NameColumn:
+		return T("OBSScoreboard.Bindings.Column.Name");
+	case OffsetColumn:
+		return T("OBSScoreboard.Bindings.Column.Item");
+	case LengthColumn:
+		return T("OBSScoreboard.Bindings.Column.Length");
+	case TargetColumn:
+		return T("OBSScoreboard.Bindings.Column.Target");
+	case ValueColumn:
+		return T("OBSScoreboard.Bindings.Column.Value");
+	}
+
+	return QVariant();
+}
+
+Qt::ItemFlags BindingModel::flags(const QModelIndex &index) const
+{
+	Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+
+	// the name is the only thing edited in place; the rest has its own
+	// dialog
+	if (index.column() == NameColumn)
+		flags |= Qt::ItemIsEditable;
+
+	return flags;
+}
+
+bool BindingModel::setData(const QModelIndex &index, const QVariant &value,
+			   int role)
+{
+	if (!index.isValid() || index.column() != NameColumn ||
+	    role != Qt::EditRole)
+		return false;
+
+	BindingPtr binding = bindingAt(index.row());
+	int row = findRow(binding);
+	if (row == -1)
+		return false;
+
+	std::vector<BindingPtr> list = set->bindings;
+	auto renamed = std::make_shared<Binding>(*binding);
+	renamed->name = value.toString().toStdString();
+	list[row] = renamed;
+
+	// only the name, so the value on the source and the clock stand
+	receiver->carryState(binding, renamed);
+	publish(std::move(list));
+
+	emit dataChanged(this->index(row, NameColumn),
+			 this->index(row, NameColumn));
+	emit edited();
+	return true;
+}
+
+BindingPtr BindingModel::bindingAt(int row) const
+{
+	if (row < 0 || row >= rowCount())
+		return nullptr;
+	return set->bindings[row];
+}
+
+int BindingModel::addBinding()
+{
+	sync();
+	int row = rowCount();
+
+	auto binding = std::make_shared<Binding>();
+	std::vector<BindingPtr> list = set->bindings;
+	list.push_back(binding);
+
+	beginInsertRows(QModelIndex(), row, row);
+	publish(std::move(list));
+	targets.push_back(describeTarget(*binding));
+	endInsertRows();
+
+	rebuild();
+	emit edited();
+	return row;
+}
+
+void BindingModel::removeBinding(int row)
+{
+	row = findRow(bindingAt(row));
+	if (row == -1)
+		return;
+
+	std::vector<BindingPtr> list = set->bindings;
+	list.erase(list.begin() + row);
+
+	beginRemoveRows(QModelIndex(), row, row);
+	publish(std::move(list));
+	targets.erase(targets.begin() + row);
+	endRemoveRows();
+
+	rebuild();
+	emit edited();
+}
+
+void BindingModel::reload()
+{
+	beginResetModel();
+
+	set = receiver->getBindings();
+	targets.clear();
+	for (auto &binding : set->bindings)
+		targets.push_back(describeTarget(*binding));
+
+	endResetModel();
+
+	rebuild();
+}
+
+void BindingModel::sync()
+{
+	if (set != receiver->getBindings())
+		reload();
+}
+
+int BindingModel::findRow(const BindingPtr &binding)
+{
+	if (!binding)
+		return -1;
+
+	sync();
+
+	auto &list = set->bindings;
+	auto it = std::find(list.begin(), list.end(), binding);
+	return it == list.end() ? -1 : (int)(it - list.begin());
+}
+
+void BindingModel::publish(std::vector<BindingPtr> list)
+{
+	set = receiver->publishBindings(std::move(list));
+}
+
+void BindingModel::rebuild()
+{
+	spans.clear();
+	longestSpan = 0;
+
+	for (size_t i = 0; i < set->bindings.size(); i++) {
+		const Binding &binding = *set->bindings[i];
+		if (!binding.inBounds())
+			continue;
+
+		size_t begin = binding.item_number - 1;
+		spans.push_back({begin, begin + binding.field_length, (int)i});
+		longestSpan = std::max<size_t>(longestSpan,
+					       binding.field_length);
+	}
+
+	std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) {
+		return a.begin < b.begin;
+	});
+}
+
+void BindingModel::flushChanges()
+{
+	std::vector<int> rows;
+
+	for (auto &range : changes->ranges()) {
+		// nothing that starts further back than the longest field can
+		// reach this range
+		size_t from = range.first > longestSpan
+				      ? range.first - longestSpan
+				      : 0;
+		auto it = std::lower_bound(spans.begin(), spans.end(), from,
+					   [](const Span &span, size_t value) {
+						   return span.begin < value;
+					   });
+
+		for (; it != spans.end() && it->begin < range.second; it++) {
+			if (it->end > range.first)
+				rows.push_back(it->row);
+		}
+	}
+	changes->clear();
+
+	std::sort(rows.begin(), rows.end());
+	rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+	// one signal for each run of consecutive rows
+	for (size_t i = 0; i < rows.size();) {
+		size_t j = i;
+		while (j + 1 < rows.size() && rows[j + 1] == rows[j] + 1)
+			j++;
+
+		emit dataChanged(index(rows[i], ValueColumn),
+				 index(rows[j], ValueColumn));
+		i = j + 1;
+	}
+}
+
+QString BindingModel::describeTarget(const Binding &binding) const
+{
+	OBSSourceAutoRelease source =
+		obs_get_source_by_uuid(binding.source_id.c_str());
+	if (!source)
+		return T("OBSScoreboard.Bindings.NoSource");
+
+	QString name = obs_source_get_name(source);
+
+	const char *type = nullptr;
+	if (binding.target_type == TARGET_VISIBILITY)
+		type = "OBSScoreboard.Binding.Target.Visibility";
+	else if (binding.target_type == TARGET_IMAGE_SWAP)
+		type = "OBSScoreboard.Binding.Target.ImageSwap";
+
+	if (type)
+		return name + " (" + T(type) + ")";
+
+	QStringList path;
+	for (auto &prop : binding.parent_prop)
+		path.append(QString::fromStdString(prop));
+
+	return name + " / " + path.join('.');
+}
+
+QString BindingModel::describeValue(const Binding &binding) const
+{
+	std::string value;
+	receiver->copyRange(binding.item_number, binding.field_length, value);
+
+	// scene item targets only care whether the field is blank
+	if (binding.target_type != TARGET_PROPERTY) {
+		bool on = value.find_first_not_of(' ') != std::string::npos;
+		if (binding.invert_bool)
+			on = !on;
+		return on ? T("OBSScoreboard.Bindings.Shown")
+			  : T("OBSScoreboard.Bindings.Hidden");
+	}
+
+	if (binding.trim_str) {
+		size_t first = value.find_first_not_of(' ');
+		size_t last = value.find_last_not_of(' ');
+		value = first == std::string::npos
+				? std::string()
+				: value.substr(first, last - first + 1);
+	}
+
+	return QString::fromStdString(value);
+}
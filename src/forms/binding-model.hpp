@@ -0,0 +1,90 @@
+#ifndef BindingModel_H
+#define BindingModel_H
+
+#include <QAbstractTableModel>
+#include <QString>
+
+#include <vector>
+
+#include "table-changes.hpp"
+#include "../receiver.hpp"
+
+// The receiver's bindings as a table, along with the value each of them
+// reads right now. The rows follow one published binding set, and edits
+// made here publish the next. Changes to the score table are collected as
+// they come in and turned into dataChanged for just the rows they touch, a
+// few times a second at most, so a busy feed can't swamp the view.
+class BindingModel : public QAbstractTableModel {
+	Q_OBJECT
+
+public:
+	enum Column {
+		NameColumn,
+		OffsetColumn,
+		LengthColumn,
+		TargetColumn,
+		ValueColumn,
+		ColumnCount
+	};
+
+	explicit BindingModel(QObject *parent);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(
+		const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+			    int role) const override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+	bool setData(const QModelIndex &index, const QVariant &value,
+		     int role) override;
+
+	BindingPtr bindingAt(int row) const;
+
+	// returns the new binding's row
+	int addBinding();
+	void removeBinding(int row);
+
+	// picks up the latest binding set, after it was published elsewhere
+	void reload();
+
+	// values only follow the score table while live
+	inline void setLive(bool live) { changes->setLive(live); }
+
+signals:
+	// the bindings need saving
+	void edited();
+
+private slots:
+	void flushChanges();
+
+private:
+	TableChanges *changes;
+
+	// the set the rows were laid out from
+	BindingSetPtr set;
+
+	// each binding's field, sorted by where it starts
+	struct Span {
+		size_t begin;
+		size_t end;
+		int row;
+	};
+	std::vector<Span> spans;
+	size_t longestSpan;
+
+	// source names and the like don't change with the score
+	std::vector<QString> targets;
+
+	// edits start from the latest set, so nothing published elsewhere
+	// in the meantime is lost
+	void sync();
+	// where a binding ended up after a sync, or -1 if it's gone
+	int findRow(const BindingPtr &binding);
+	void publish(std::vector<BindingPtr> list);
+	void rebuild();
+	QString describeTarget(const Binding &binding) const;
+	QString describeValue(const Binding &binding) const;
+};
+
+#endif // BindingModel_H
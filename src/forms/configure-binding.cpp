@@ -2,6 +2,8 @@
 
 #include <obs.hpp>
 
+#include <QPushButton>
+
 #include "configure-binding.hpp"
 
 #include "ui_configure-binding.h"
@@ -20,12 +22,42 @@ ConfigureBinding::ConfigureBinding(QWidget *parent)
 	// Remove the ? button on dialogs on Windows
 	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
 
+	ui->targetComboBox->addItem(T("OBSScoreboard.Binding.Target.Property"),
+				    TARGET_PROPERTY);
+	ui->targetComboBox->addItem(
+		T("OBSScoreboard.Binding.Target.Visibility"),
+		TARGET_VISIBILITY);
+	ui->targetComboBox->addItem(T("OBSScoreboard.Binding.Target.ImageSwap"),
+				    TARGET_IMAGE_SWAP);
+
+	ui->priorityComboBox->addItem(
+		T("OBSScoreboard.Binding.Priority.Immediate"),
+		PRIORITY_IMMEDIATE);
+	ui->priorityComboBox->addItem(
+		T("OBSScoreboard.Binding.Priority.Normal"), PRIORITY_NORMAL);
+	ui->priorityComboBox->addItem(T("OBSScoreboard.Binding.Priority.Low"),
+				      PRIORITY_LOW);
+
+	connect(ui->targetComboBox, &QComboBox::currentIndexChanged, this,
+		&ConfigureBinding::targetChanged);
 	connect(ui->refreshSourceListButton, &QPushButton::clicked, this,
 		&ConfigureBinding::refreshSourceList);
 	connect(ui->sourceComboBox, &QComboBox::currentIndexChanged, this,
 		&ConfigureBinding::sourceChanged);
 	connect(ui->buttonBox, &QDialogButtonBox::accepted, this,
 		&ConfigureBinding::saved);
+
+	fieldMaximum = ui->lengthBox->maximum();
+	connect(ui->itemNoBox, &QSpinBox::valueChanged, this,
+		&ConfigureBinding::fieldChanged);
+	connect(ui->lengthBox, &QSpinBox::valueChanged, this,
+		&ConfigureBinding::fieldChanged);
+	connect(ui->tableRowsBox, &QSpinBox::valueChanged, this,
+		&ConfigureBinding::fieldChanged);
+	connect(ui->tableStrideBox, &QSpinBox::valueChanged, this,
+		&ConfigureBinding::fieldChanged);
+	connect(ui->tableColumnsEdit, &QLineEdit::textChanged, this,
+		&ConfigureBinding::fieldChanged);
 }
 
 ConfigureBinding::~ConfigureBinding()
@@ -55,13 +87,131 @@ extern "C" bool add_source_to_combobox(void *arg, obs_source_t *source)
 	return true;
 }
 
+extern "C" bool add_sceneitem_to_combobox(obs_scene_t *scene,
+					  obs_sceneitem_t *item, void *arg)
+{
+	UNUSED_PARAMETER(scene);
+
+	auto box = (QComboBox *)arg;
+
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	qint64 id = obs_sceneitem_get_id(item);
+
+	box->addItem(obs_source_get_name(source), QVariant::fromValue(id));
+
+	return true;
+}
+
+uint32_t ConfigureBinding::currentTarget() const
+{
+	return ui->targetComboBox->currentData().toUInt();
+}
+
+void ConfigureBinding::targetChanged()
+{
+	uint32_t target = currentTarget();
+
+	if (target == TARGET_PROPERTY) {
+		ui->sourceLabel->setText(T("OBSScoreboard.Binding.Source"));
+		ui->propLabel->setText(T("OBSScoreboard.Binding.Prop"));
+	} else {
+		ui->sourceLabel->setText(T("OBSScoreboard.Binding.Scene"));
+		ui->propLabel->setText(
+			target == TARGET_IMAGE_SWAP
+				? T("OBSScoreboard.Binding.ShownWhenTrue")
+				: T("OBSScoreboard.Binding.SceneItem"));
+	}
+
+	ui->altItemLabel->setVisible(target == TARGET_IMAGE_SWAP);
+	ui->altItemComboBox->setVisible(target == TARGET_IMAGE_SWAP);
+	ui->trimStrCheckbox->setEnabled(target == TARGET_PROPERTY);
+	ui->clockModeCheckbox->setEnabled(target == TARGET_PROPERTY);
+	ui->tableRowsBox->setEnabled(target == TARGET_PROPERTY);
+	fieldChanged();
+
+	refreshSourceList();
+}
+
+void ConfigureBinding::fieldChanged()
+{
+	bool table = currentTarget() == TARGET_PROPERTY &&
+		     ui->tableRowsBox->value() > 0;
+
+	ui->tableStrideBox->setEnabled(table);
+	ui->tableColumnsEdit->setEnabled(table);
+	ui->lengthBox->setEnabled(!table);
+	ui->clockModeCheckbox->setEnabled(currentTarget() == TARGET_PROPERTY &&
+					  !table);
+
+	uint64_t item = ui->itemNoBox->value();
+	uint64_t length = ui->lengthBox->value();
+	QString error;
+
+	// the field is the whole block
+	ui->lengthBox->setMaximum(table ? SCORE_TABLE_MAX_CAPACITY
+					: fieldMaximum);
+	if (table) {
+		TableLayout layout;
+		layout.rows = ui->tableRowsBox->value();
+		layout.stride = ui->tableStrideBox->value();
+		if (!layout.parseColumns(
+			    ui->tableColumnsEdit->text().toStdString()))
+			error = T("OBSScoreboard.Binding.Error.Columns");
+
+		length = layout.span();
+		if (error.isEmpty() && length <= SCORE_TABLE_MAX_CAPACITY)
+			ui->lengthBox->setValue((int)length);
+	}
+
+	// the table is sized from the bindings, so one that runs off the end
+	// of the largest can't be saved
+	if (error.isEmpty() && item - 1 + length > SCORE_TABLE_MAX_CAPACITY)
+		error = QString(T("OBSScoreboard.Binding.Error.OutOfRange"))
+				.arg(SCORE_TABLE_MAX_CAPACITY);
+
+	ui->fieldError->setText(error);
+	ui->fieldError->setVisible(!error.isEmpty());
+	ui->buttonBox->button(QDialogButtonBox::Ok)
+		->setEnabled(error.isEmpty());
+}
+
 void ConfigureBinding::refreshSourceList()
 {
 	ui->sourceComboBox->clear();
 
 	add_to_source_combobox_arg arg{ui->sourceComboBox, this};
 
-	obs_enum_sources(&add_source_to_combobox, &arg);
+	// scene item targets are picked from the scene that holds them
+	if (currentTarget() == TARGET_PROPERTY)
+		obs_enum_sources(&add_source_to_combobox, &arg);
+	else
+		obs_enum_scenes(&add_source_to_combobox, &arg);
+}
+
+void ConfigureBinding::addSceneItems(obs_source_t *source)
+{
+	obs_scene_t *scene = obs_scene_from_source(source);
+
+	if (!scene)
+		return;
+
+	obs_scene_enum_items(scene, &add_sceneitem_to_combobox,
+			     ui->propComboBox);
+	obs_scene_enum_items(scene, &add_sceneitem_to_combobox,
+			     ui->altItemComboBox);
+
+	int index = ui->propComboBox->findData(
+		QVariant::fromValue<qint64>(active->scene_item_id));
+	if (index != -1)
+		ui->propComboBox->setCurrentIndex(index);
+
+	index = ui->altItemComboBox->findData(
+		QVariant::fromValue<qint64>(active->alt_scene_item_id));
+	if (index != -1)
+		ui->altItemComboBox->setCurrentIndex(index);
+
+	ui->propComboBox->setEnabled(true);
+	ui->altItemComboBox->setEnabled(true);
 }
 
 void ConfigureBinding::addPropertiesObjectRecursive(
@@ -109,12 +259,19 @@ void ConfigureBinding::sourceChanged()
 
 	ui->propComboBox->clear();
 	ui->propComboBox->setEnabled(false);
+	ui->altItemComboBox->clear();
+	ui->altItemComboBox->setEnabled(false);
 
 	OBSSourceAutoRelease source = obs_get_source_by_uuid(uuid.constData());
 
 	if (!source)
 		return;
 
+	if (currentTarget() != TARGET_PROPERTY) {
+		addSceneItems(source);
+		return;
+	}
+
 	obs_properties_t *props = obs_source_properties(source);
 
 	std::map<std::string, std::string> map;
@@ -153,42 +310,101 @@ void ConfigureBinding::sourceChanged()
 	ui->propComboBox->setEnabled(true);
 }
 
-void ConfigureBinding::openForBinding(Binding *binding)
+void ConfigureBinding::openForBinding(const BindingPtr &binding)
 {
 	active = binding;
 
 	ui->enableCheckbox->setChecked(active->enabled);
 	ui->itemNoBox->setValue(active->item_number);
 	ui->lengthBox->setValue(active->field_length);
-	refreshSourceList();
+	ui->tableRowsBox->setValue(active->table.rows);
+	ui->tableStrideBox->setValue(active->table.stride);
+	ui->tableColumnsEdit->setText(
+		QString::fromStdString(active->table.formatColumns()));
+
+	{
+		// targetChanged refreshes the source list once we're done here
+		QSignalBlocker blocker(ui->targetComboBox);
+		ui->targetComboBox->setCurrentIndex(
+			ui->targetComboBox->findData(active->target_type));
+	}
+	targetChanged();
 	ui->trimStrCheckbox->setChecked(active->trim_str);
 	ui->invertBoolCheckbox->setChecked(active->invert_bool);
+	ui->clockModeCheckbox->setChecked(active->clock_mode);
+	ui->priorityComboBox->setCurrentIndex(
+		ui->priorityComboBox->findData(active->priority));
+	ui->holdTimeBox->setValue(active->hold_ms);
+	ui->holdUpdatesBox->setValue(active->hold_updates);
+	ui->minIntervalBox->setValue(active->min_interval_ms);
 
 	open();
 }
 
 void ConfigureBinding::saved()
 {
-	active->enabled = ui->enableCheckbox->isChecked();
-	active->item_number = ui->itemNoBox->value();
-	active->field_length = ui->lengthBox->value();
-	active->source_id =
+	// published bindings are never changed, so the edit goes into a copy
+	// that takes the original's place
+	auto edited = std::make_shared<Binding>(*active);
+
+	edited->enabled = ui->enableCheckbox->isChecked();
+	edited->item_number = ui->itemNoBox->value();
+	edited->field_length = ui->lengthBox->value();
+	edited->source_id =
 		ui->sourceComboBox->currentData().toString().toStdString();
+	edited->target_type = currentTarget();
+	edited->priority = ui->priorityComboBox->currentData().toUInt();
+	edited->hold_ms = ui->holdTimeBox->value();
+	// a single update is no hold at all
+	edited->hold_updates = ui->holdUpdatesBox->value() > 1
+				       ? ui->holdUpdatesBox->value()
+				       : 0;
+	edited->min_interval_ms = ui->minIntervalBox->value();
+
+	edited->parent_prop.clear();
+
+	if (edited->target_type != TARGET_PROPERTY) {
+		edited->flag_value = 0;
+		edited->scene_item_id =
+			ui->propComboBox->currentData().toLongLong();
+		edited->alt_scene_item_id =
+			ui->altItemComboBox->currentData().toLongLong();
+		edited->trim_str = false;
+		edited->invert_bool = ui->invertBoolCheckbox->isChecked();
+		edited->clock_mode = false;
+	} else {
+		auto flagsplit_arr =
+			ui->propComboBox->currentData().toString().split('#');
+		if (flagsplit_arr.length() == 2)
+			edited->flag_value = flagsplit_arr[1].toInt();
+		else
+			edited->flag_value = 0;
+
+		auto proplist = flagsplit_arr[0].split('.');
+		for (auto &str : proplist)
+			edited->parent_prop.emplace_back(
+				str.toUtf8().toStdString());
+
+		edited->trim_str = ui->trimStrCheckbox->isChecked();
+		edited->invert_bool = ui->invertBoolCheckbox->isChecked();
+		edited->clock_mode = ui->clockModeCheckbox->isChecked();
+	}
 
-	active->parent_prop.clear();
-	auto flagsplit_arr =
-		ui->propComboBox->currentData().toString().split('#');
-	if (flagsplit_arr.length() == 2)
-		active->flag_value = flagsplit_arr[1].toInt();
-	else
-		active->flag_value = 0;
-
-	auto proplist = flagsplit_arr[0].split('.');
-	for (auto &str : proplist)
-		active->parent_prop.emplace_back(str.toUtf8().toStdString());
-
-	active->trim_str = ui->trimStrCheckbox->isChecked();
-	active->invert_bool = ui->invertBoolCheckbox->isChecked();
+	// rows of a block instead of one field, shown as lines of text
+	edited->table = TableLayout();
+	if (edited->target_type == TARGET_PROPERTY &&
+	    ui->tableRowsBox->value() > 0) {
+		edited->table.rows = ui->tableRowsBox->value();
+		edited->table.stride = ui->tableStrideBox->value();
+		edited->table.parseColumns(
+			ui->tableColumnsEdit->text().toStdString());
+		edited->field_length = edited->table.span();
+		edited->clock_mode = false;
+	}
 
+	// a new binding starts out fresh on the update path, so whatever the
+	// source shows now, the field is pushed to it again
+	receiver->replaceBinding(active, edited);
+	active = edited;
 	receiver->saveConfig();
 }
@@ -17,15 +17,19 @@ public:
 	explicit ConfigureBinding(QWidget *parent);
 	~ConfigureBinding();
 
-	Binding *active;
+	BindingPtr active;
 
 public slots:
 
+	void targetChanged();
+
+	void fieldChanged();
+
 	void sourceChanged();
 
 	void refreshSourceList();
 
-	void openForBinding(Binding *binding);
+	void openForBinding(const BindingPtr &binding);
 
 	void saved();
 
@@ -36,7 +40,15 @@ private:
 				     const std::string &setting_prefix,
 				     const std::string &description_prefixs);
 
+	void addSceneItems(obs_source_t *source);
+
+	uint32_t currentTarget() const;
+
 	Ui::ConfigureBinding *ui;
+
+	// the longest single field, from the form; a table's block can be
+	// longer
+	int fieldMaximum;
 };
 
 #endif // ConfigureBinding_H
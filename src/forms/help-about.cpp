@@ -1,4 +1,5 @@
 #include <obs.hpp>
+#include <util/platform.h>
 
 #include "help-about.hpp"
 
@@ -19,6 +20,10 @@ HelpAbout::HelpAbout(QWidget *parent) : QDialog(parent), ui(new Ui::HelpAbout)
 
 	connect(receiver, &Receiver::counterChanged, this,
 		&HelpAbout::counterChanged);
+
+	// input statistics change with every frame, so poll them instead
+	inputTimer = new QTimer(this);
+	connect(inputTimer, &QTimer::timeout, this, &HelpAbout::refreshInputs);
 }
 
 HelpAbout::~HelpAbout()
@@ -30,6 +35,41 @@ void HelpAbout::toggleVisible(bool checked)
 {
 	UNUSED_PARAMETER(checked);
 	setVisible(!isVisible());
+
+	if (isVisible()) {
+		refreshInputs();
+		inputTimer->start(1000);
+	} else {
+		inputTimer->stop();
+	}
+}
+
+void HelpAbout::refreshInputs()
+{
+	auto &stats = receiver->getInputStats();
+	uint64_t now = os_gettime_ns();
+
+	while (ui->inputList->topLevelItemCount() > (int)stats.size())
+		delete ui->inputList->takeTopLevelItem(0);
+	while (ui->inputList->topLevelItemCount() < (int)stats.size())
+		ui->inputList->addTopLevelItem(new QTreeWidgetItem());
+
+	for (size_t i = 0; i < stats.size(); i++) {
+		auto &input = stats[i];
+		QTreeWidgetItem *item = ui->inputList->topLevelItem((int)i);
+
+		item->setText(0, receiver->inputName(i));
+		item->setText(1, QString::number(input.frames));
+		item->setText(2, QString::number(input.first));
+		item->setText(3, QString::number(input.duplicates));
+		item->setText(4, QString::number(input.latency_ms, 'f', 1));
+
+		QString lastSeen = "-";
+		if (input.last_ns)
+			lastSeen = QString::number(
+				(now - input.last_ns) / 1000000000.0, 'f', 1);
+		item->setText(5, lastSeen);
+	}
 }
 
 void HelpAbout::counterChanged(int which, unsigned long long newval)
@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include <QLabel>
+#include <QTimer>
 
 namespace Ui {
 class HelpAbout;
@@ -25,7 +26,11 @@ private slots:
 
 	void counterChanged(int which, unsigned long long newval);
 
+	void refreshInputs();
+
 private:
+	QTimer *inputTimer;
+
 	Ui::HelpAbout *ui;
 };
 
@@ -0,0 +1,134 @@
+#include <obs.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#include <QFontDatabase>
+#include <QHeaderView>
+
+#include "configure-binding.hpp"
+#include "inspector.hpp"
+#include "../receiver.hpp"
+
+#include "ui_inspector.h"
+
+#include "../plugin-macros.generated.h"
+
+extern Receiver *receiver;
+extern ConfigureBinding *config;
+
+// the longest field the binding dialog accepts
+#define MAX_PRESET_LENGTH 1024
+
+Inspector::Inspector(QWidget *parent) : QDialog(parent), ui(new Ui::Inspector)
+{
+	ui->setupUi(this);
+
+	// Remove the ? button on dialogs on Windows
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+	model = new ScoreTableModel(this);
+	ui->grid->setModel(model);
+
+	// fixed sizes let the view work out what's visible without asking
+	// about every row, which is what keeps a large table cheap
+	QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+	QFontMetrics metrics(font);
+	ui->grid->setFont(font);
+	ui->grid->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui->grid->horizontalHeader()->setDefaultSectionSize(
+		metrics.horizontalAdvance("+00") + 8);
+	ui->grid->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui->grid->verticalHeader()->setDefaultSectionSize(metrics.height() + 4);
+
+	connect(ui->grid->selectionModel(),
+		&QItemSelectionModel::selectionChanged, this,
+		&Inspector::selectionChanged);
+	connect(model, &QAbstractItemModel::modelReset, this,
+		&Inspector::selectionChanged);
+	connect(ui->resetButton, &QPushButton::clicked, model,
+		&ScoreTableModel::reset);
+	connect(ui->createButton, &QPushButton::clicked, this,
+		&Inspector::createClicked);
+	connect(this, &QDialog::finished, this, &Inspector::closed);
+
+	selectionChanged();
+}
+
+Inspector::~Inspector()
+{
+	delete ui;
+}
+
+void Inspector::toggleVisible()
+{
+	bool visible = !isVisible();
+
+	if (visible)
+		model->reset();
+
+	model->setLive(visible);
+	setVisible(visible);
+}
+
+void Inspector::closed()
+{
+	model->setLive(false);
+}
+
+bool Inspector::selectedRange(size_t &begin, size_t &end) const
+{
+	QModelIndexList cells = ui->grid->selectionModel()->selectedIndexes();
+	if (cells.isEmpty())
+		return false;
+
+	// a selection running over several rows takes everything from the
+	// first cell to the last, the way the table is laid out
+	begin = SIZE_MAX;
+	end = 0;
+	for (auto &cell : cells) {
+		size_t offset = ScoreTableModel::offsetOf(cell);
+		begin = std::min(begin, offset);
+		end = std::max(end, offset + 1);
+	}
+
+	return true;
+}
+
+void Inspector::selectionChanged()
+{
+	size_t begin, end;
+	bool selected = selectedRange(begin, end);
+
+	ui->createButton->setEnabled(selected &&
+				     end - begin <= MAX_PRESET_LENGTH);
+
+	if (!selected) {
+		ui->selectionLabel->clear();
+		return;
+	}
+
+	ui->selectionLabel->setText(
+		QString(T("OBSScoreboard.Inspector.Selection"))
+			.arg(begin + 1)
+			.arg(end - begin));
+}
+
+void Inspector::createClicked()
+{
+	size_t begin, end;
+	if (!selectedRange(begin, end))
+		return;
+
+	// the rest is filled in by the binding dialog straight away
+	auto binding = std::make_shared<Binding>();
+	binding->item_number = (uint32_t)begin + 1;
+	binding->field_length = (uint32_t)(end - begin);
+
+	std::vector<BindingPtr> list = receiver->getBindings()->bindings;
+	list.push_back(binding);
+	receiver->publishBindings(std::move(list));
+	receiver->saveConfig();
+
+	config->openForBinding(binding);
+}
@@ -0,0 +1,38 @@
+#ifndef Inspector_H
+#define Inspector_H
+
+#include <QDialog>
+
+#include "score-table-model.hpp"
+
+namespace Ui {
+class Inspector;
+}
+
+class Inspector : public QDialog {
+	Q_OBJECT
+
+public:
+	explicit Inspector(QWidget *parent);
+	~Inspector();
+
+	void toggleVisible();
+
+private slots:
+
+	void selectionChanged();
+
+	void createClicked();
+
+	void closed();
+
+private:
+	// the selected [begin, end) of the table, false if there's none
+	bool selectedRange(size_t &begin, size_t &end) const;
+
+	ScoreTableModel *model;
+
+	Ui::Inspector *ui;
+};
+
+#endif // Inspector_H
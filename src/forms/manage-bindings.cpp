@@ -1,5 +1,7 @@
 #include <obs.hpp>
 
+#include <algorithm>
+
 #include "configure-binding.hpp"
 #include "manage-bindings.hpp"
 #include "../receiver.hpp"
@@ -11,6 +13,9 @@
 extern Receiver *receiver;
 extern ConfigureBinding *config;
 
+// how long edits have to settle before they're written to the config
+#define SAVE_DELAY 1000
+
 ManageBindings::ManageBindings(QWidget *parent)
 	: QDialog(parent), ui(new Ui::ManageBindings)
 {
@@ -19,10 +24,25 @@ ManageBindings::ManageBindings(QWidget *parent)
 	// Remove the ? button on dialogs on Windows
 	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
 
-	connect(ui->bindingList, &QListWidget::currentRowChanged, this,
+	model = new BindingModel(this);
+	ui->bindingTable->setModel(model);
+
+	saveTimer = new QTimer(this);
+	saveTimer->setSingleShot(true);
+	saveTimer->setInterval(SAVE_DELAY);
+	connect(saveTimer, &QTimer::timeout, receiver, &Receiver::saveConfig);
+	connect(model, &BindingModel::edited, saveTimer,
+		qOverload<>(&QTimer::start));
+
+	connect(ui->bindingTable->selectionModel(),
+		&QItemSelectionModel::selectionChanged, this,
 		&ManageBindings::rowChanged);
-	connect(ui->bindingList, &QListWidget::itemChanged, this,
-		&ManageBindings::rowRenamed);
+	connect(ui->bindingTable, &QAbstractItemView::doubleClicked, this,
+		[this](const QModelIndex &index) {
+			// the name is edited in place
+			if (index.column() != BindingModel::NameColumn)
+				editClicked();
+		});
 	connect(ui->editButton, &QPushButton::clicked, this,
 		&ManageBindings::editClicked);
 	connect(ui->renameButton, &QPushButton::clicked, this,
@@ -31,6 +51,21 @@ ManageBindings::ManageBindings(QWidget *parent)
 		&ManageBindings::addClicked);
 	connect(ui->removeBindingButton, &QPushButton::clicked, this,
 		&ManageBindings::deleteClicked);
+	connect(this, &QDialog::finished, this, &ManageBindings::closed);
+
+	// the binding dialog saves for itself, but its changes show up here
+	connect(config, &QDialog::finished, model, &BindingModel::reload);
+
+	// another scene collection's bindings, and whatever was being edited
+	// belongs to the one that was left
+	connect(receiver, &Receiver::bindingsSwitched, model,
+		&BindingModel::reload);
+	connect(receiver, &Receiver::bindingsSwitched, config, []() {
+		if (config->isVisible())
+			config->reject();
+	});
+
+	rowChanged();
 }
 
 ManageBindings::~ManageBindings()
@@ -40,79 +75,84 @@ ManageBindings::~ManageBindings()
 
 void ManageBindings::toggleVisible()
 {
-	redraw();
-	setVisible(!isVisible());
+	bool visible = !isVisible();
+
+	if (visible) {
+		int row = currentRow();
+		model->reload();
+		selectRow(row);
+	}
+
+	model->setLive(visible);
+	setVisible(visible);
+
+	if (!visible)
+		closed();
 }
 
-void ManageBindings::rowChanged(int row)
+void ManageBindings::closed()
 {
-	bool active = row != -1;
+	model->setLive(false);
 
-	ui->removeBindingButton->setEnabled(active);
-	ui->editButton->setEnabled(active);
-	ui->renameButton->setEnabled(active);
+	// don't leave anything unsaved while nobody's looking
+	if (saveTimer->isActive()) {
+		saveTimer->stop();
+		receiver->saveConfig();
+	}
 }
 
-void ManageBindings::renameClicked()
+int ManageBindings::currentRow() const
 {
-	auto current = ui->bindingList->currentItem();
-	ui->bindingList->editItem(current);
+	QModelIndexList rows =
+		ui->bindingTable->selectionModel()->selectedRows();
+	return rows.isEmpty() ? -1 : rows.first().row();
 }
 
-void ManageBindings::editClicked()
+void ManageBindings::selectRow(int row)
 {
-	int index = ui->bindingList->currentIndex().row();
-	auto &binding = receiver->bindings[index];
-	config->openForBinding(&binding);
-	return;
+	if (row < 0 || row >= model->rowCount())
+		return;
+
+	ui->bindingTable->selectRow(row);
+	ui->bindingTable->scrollTo(model->index(row, 0));
 }
 
-void ManageBindings::addClicked()
+void ManageBindings::rowChanged()
 {
-	receiver->bindings.emplace_back();
-	receiver->saveConfig();
-	redraw();
-
-	// select the current row
-	int newRowIndex = static_cast<int>(receiver->bindings.size() - 1);
-	ui->bindingList->setCurrentRow(newRowIndex);
-	rowChanged(newRowIndex);
+	bool active = currentRow() != -1;
+
+	ui->removeBindingButton->setEnabled(active);
+	ui->editButton->setEnabled(active);
+	ui->renameButton->setEnabled(active);
 }
 
-void ManageBindings::deleteClicked()
+void ManageBindings::renameClicked()
 {
-	int currentIndex = ui->bindingList->currentRow();
-	auto it = receiver->bindings.begin() + currentIndex;
-	receiver->bindings.erase(it);
-	receiver->saveConfig();
-	redraw();
+	int row = currentRow();
+	if (row != -1)
+		ui->bindingTable->edit(
+			model->index(row, BindingModel::NameColumn));
 }
 
-void ManageBindings::rowRenamed(QListWidgetItem *item)
+void ManageBindings::editClicked()
 {
-	int currentIndex = ui->bindingList->indexFromItem(item).row();
-	auto currentBinding = receiver->bindings.begin() + currentIndex;
+	int row = currentRow();
+	if (row == -1)
+		return;
 
-	currentBinding->name = item->text().toStdString();
-	receiver->saveConfig();
+	config->openForBinding(model->bindingAt(row));
 }
 
-void ManageBindings::redraw()
+void ManageBindings::addClicked()
 {
-	int currentRow = ui->bindingList->currentRow();
-
-	ui->bindingList->clear();
-	for (auto &binding : receiver->bindings) {
-		ui->bindingList->addItem(binding.name.c_str());
-	}
+	selectRow(model->addBinding());
+}
 
-	int item_count = ui->bindingList->count();
-	for (int i = 0; i < item_count; i++) {
-		QListWidgetItem *item = ui->bindingList->item(i);
-		if (!item)
-			break;
-		item->setFlags(item->flags() | Qt::ItemIsEditable);
-	}
+void ManageBindings::deleteClicked()
+{
+	int row = currentRow();
+	model->removeBinding(row);
 
-	ui->bindingList->setCurrentRow(currentRow);
+	// keep the selection where it was, or on the new last row
+	selectRow(std::min(row, model->rowCount() - 1));
 }
@@ -3,7 +3,9 @@
 
 #include <QDialog>
 #include <QLabel>
-#include <QListWidgetItem>
+#include <QTimer>
+
+#include "binding-model.hpp"
 
 namespace Ui {
 class ManageBindings;
@@ -20,9 +22,7 @@ public:
 
 private slots:
 
-	void rowChanged(int row);
-
-	void rowRenamed(QListWidgetItem *item);
+	void rowChanged();
 
 	void editClicked();
 
@@ -32,8 +32,16 @@ private slots:
 
 	void deleteClicked();
 
+	void closed();
+
 private:
-	void redraw();
+	int currentRow() const;
+	void selectRow(int row);
+
+	BindingModel *model;
+
+	// edits are saved once they settle, not one by one
+	QTimer *saveTimer;
 
 	Ui::ManageBindings *ui;
 };
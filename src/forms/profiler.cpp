@@ -0,0 +1,204 @@
+#include <obs.hpp>
+
+#include <cmath>
+
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QSaveFile>
+
+#include "profiler.hpp"
+#include "../receiver.hpp"
+
+#include "ui_profiler.h"
+
+#include "../plugin-macros.generated.h"
+
+extern Receiver *receiver;
+
+// how often the report is worked out again while it's showing, in
+// milliseconds
+#define REFRESH_INTERVAL 2000
+
+static const char *priorityNames[PRIORITY_COUNT] = {
+	"OBSScoreboard.Binding.Priority.Immediate",
+	"OBSScoreboard.Binding.Priority.Normal",
+	"OBSScoreboard.Binding.Priority.Low",
+};
+
+static QTableWidgetItem *numberItem(double value)
+{
+	QTableWidgetItem *item = new QTableWidgetItem();
+	item->setData(Qt::DisplayRole, value);
+	item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	return item;
+}
+
+static QTableWidgetItem *rateItem(double rate)
+{
+	// hundredths are plenty to tell fields apart
+	return numberItem(std::round(rate * 100.0) / 100.0);
+}
+
+Profiler::Profiler(QWidget *parent) : QDialog(parent), ui(new Ui::Profiler)
+{
+	ui->setupUi(this);
+
+	// Remove the ? button on dialogs on Windows
+	setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+	ui->bindingsTable->setColumnCount(9);
+	ui->bindingsTable->setHorizontalHeaderLabels({
+		T("OBSScoreboard.Profiler.Name"),
+		T("OBSScoreboard.Profiler.Item"),
+		T("OBSScoreboard.Profiler.Length"),
+		T("OBSScoreboard.Profiler.Writes"),
+		T("OBSScoreboard.Profiler.Changes"),
+		T("OBSScoreboard.Profiler.Changed"),
+		T("OBSScoreboard.Binding.Priority"),
+		T("OBSScoreboard.Profiler.Suggested"),
+		T("OBSScoreboard.Profiler.Suppressed"),
+	});
+	ui->regionsTable->setColumnCount(7);
+	ui->regionsTable->setHorizontalHeaderLabels({
+		T("OBSScoreboard.Profiler.Item"),
+		T("OBSScoreboard.Profiler.Length"),
+		T("OBSScoreboard.Profiler.Writes"),
+		T("OBSScoreboard.Profiler.Changes"),
+		T("OBSScoreboard.Profiler.Changed"),
+		T("OBSScoreboard.Profiler.Suggested"),
+		T("OBSScoreboard.Profiler.BindingCount"),
+	});
+	for (auto table : {ui->bindingsTable, ui->regionsTable}) {
+		table->verticalHeader()->hide();
+		table->horizontalHeader()->setSectionResizeMode(
+			QHeaderView::ResizeToContents);
+	}
+
+	refreshTimer = new QTimer(this);
+	refreshTimer->setInterval(REFRESH_INTERVAL);
+	connect(refreshTimer, &QTimer::timeout, this, &Profiler::refresh);
+
+	connect(ui->resetButton, &QPushButton::clicked, this,
+		&Profiler::resetClicked);
+	connect(ui->exportButton, &QPushButton::clicked, this,
+		&Profiler::exportClicked);
+	connect(this, &QDialog::finished, this, &Profiler::closed);
+}
+
+Profiler::~Profiler()
+{
+	delete ui;
+}
+
+void Profiler::toggleVisible()
+{
+	bool visible = !isVisible();
+
+	if (visible) {
+		refresh();
+		refreshTimer->start();
+	} else {
+		refreshTimer->stop();
+	}
+
+	setVisible(visible);
+}
+
+void Profiler::closed()
+{
+	refreshTimer->stop();
+}
+
+void Profiler::refresh()
+{
+	report = receiver->profileReport();
+
+	fillTable(ui->bindingsTable, report.bindings, true);
+	fillTable(ui->regionsTable, report.regions, false);
+
+	ui->summaryLabel->setText(QString(T("OBSScoreboard.Profiler.Summary"))
+					  .arg((qulonglong)report.seconds)
+					  .arg(report.regions.size()));
+}
+
+void Profiler::fillTable(QTableWidget *table,
+			 const std::vector<ProfileRow> &rows, bool bindings)
+{
+	// rows would be moved around under us as they're filled in
+	table->setSortingEnabled(false);
+	table->setRowCount((int)rows.size());
+
+	for (int i = 0; i < (int)rows.size(); i++) {
+		const ProfileRow &row = rows[i];
+		int column = 0;
+
+		if (bindings) {
+			QString name = QString::fromStdString(row.name);
+			table->setItem(i, column++, new QTableWidgetItem(name));
+		}
+
+		table->setItem(i, column++, numberItem((double)row.offset + 1));
+		table->setItem(i, column++, numberItem((double)row.length));
+		table->setItem(i, column++, rateItem(row.writeRate));
+		table->setItem(i, column++, rateItem(row.changeRate));
+
+		// how much of what's written really changes, which is low for
+		// a field sitting in a range that's busy elsewhere
+		double changed = row.bytesWritten ? 100.0 * row.bytesChanged /
+							    row.bytesWritten
+						  : 0.0;
+		table->setItem(i, column++, rateItem(changed));
+
+		if (bindings) {
+			uint32_t priority = row.priority % PRIORITY_COUNT;
+			table->setItem(i, column++,
+				       new QTableWidgetItem(
+					       T(priorityNames[priority])));
+		}
+
+		QTableWidgetItem *suggested =
+			new QTableWidgetItem(T(priorityNames[row.suggested]));
+		if (bindings && row.priority != row.suggested) {
+			suggested->setBackground(QColor(255, 200, 80, 160));
+			suggested->setForeground(QColor(Qt::black));
+			suggested->setToolTip(
+				T("OBSScoreboard.Profiler.Mismatch"));
+		}
+		table->setItem(i, column++, suggested);
+
+		if (bindings)
+			table->setItem(i, column++,
+				       numberItem((double)row.suppressed));
+		else
+			table->setItem(i, column++,
+				       numberItem((double)row.bindings));
+	}
+
+	table->setSortingEnabled(true);
+}
+
+void Profiler::resetClicked()
+{
+	receiver->resetProfile();
+	refresh();
+}
+
+void Profiler::exportClicked()
+{
+	QString path = QFileDialog::getSaveFileName(
+		this, T("OBSScoreboard.Profiler.Export"),
+		"obs-scoreboard-profile.csv", "CSV (*.csv)");
+	if (path.isEmpty())
+		return;
+
+	// the report as it is now, rather than as of the last refresh
+	report = receiver->profileReport();
+	std::string csv = report.toCsv();
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly) ||
+	    file.write(csv.data(), (qint64)csv.size()) != (qint64)csv.size() ||
+	    !file.commit())
+		blog(LOG_WARNING, "failed to write profile to %s",
+		     path.toUtf8().constData());
+}
@@ -0,0 +1,43 @@
+#ifndef Profiler_H
+#define Profiler_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QTimer>
+
+#include "../update-profile.hpp"
+
+namespace Ui {
+class Profiler;
+}
+
+class Profiler : public QDialog {
+	Q_OBJECT
+
+public:
+	explicit Profiler(QWidget *parent);
+	~Profiler();
+
+	void toggleVisible();
+
+private slots:
+
+	void refresh();
+
+	void resetClicked();
+
+	void exportClicked();
+
+	void closed();
+
+private:
+	void fillTable(QTableWidget *table, const std::vector<ProfileRow> &rows,
+		       bool bindings);
+
+	QTimer *refreshTimer;
+	ProfileReport report;
+
+	Ui::Profiler *ui;
+};
+
+#endif // Profiler_H
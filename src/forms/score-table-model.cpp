@@ -0,0 +1,156 @@
+#include <obs.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <QColor>
+
+#include "score-table-model.hpp"
+#include "../receiver.hpp"
+
+#include "../plugin-macros.generated.h"
+
+extern Receiver *receiver;
+
+// the most a busy feed gets the grid repainted, in milliseconds
+#define REFRESH_INTERVAL 100
+
+// stands in for characters that can't be shown as they are
+#define UNPRINTABLE QChar(0x00B7)
+
+ScoreTableModel::ScoreTableModel(QObject *parent) : QAbstractTableModel(parent)
+{
+	hottest = 0;
+
+	changes = new TableChanges(REFRESH_INTERVAL, this);
+	connect(changes, &TableChanges::due, this,
+		&ScoreTableModel::flushChanges);
+}
+
+int ScoreTableModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)((shown.size() + INSPECTOR_COLUMNS - 1) /
+		     INSPECTOR_COLUMNS);
+}
+
+int ScoreTableModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return INSPECTOR_COLUMNS;
+}
+
+QVariant ScoreTableModel::data(const QModelIndex &index, int role) const
+{
+	size_t offset = offsetOf(index);
+	if (!index.isValid() || offset >= shown.size())
+		return QVariant();
+
+	unsigned char c = shown[offset];
+	uint32_t count = heat[offset];
+
+	switch (role) {
+	case Qt::DisplayRole:
+		if (c < 0x20 || c >= 0x7f)
+			return QString(UNPRINTABLE);
+		return QString(QChar(c));
+	case Qt::TextAlignmentRole:
+		return Qt::AlignCenter;
+	case Qt::ToolTipRole:
+		return QString(T("OBSScoreboard.Inspector.Cell"))
+			.arg(offset + 1)
+			.arg((int)c, 2, 16, QChar('0'))
+			.arg(count);
+	case Qt::BackgroundRole: {
+		if (!count)
+			return QVariant();
+
+		// from yellow for the odd change to red for the busiest bytes,
+		// on a log scale so a running clock doesn't wash out the rest
+		double level = std::log1p(count) / std::log1p(hottest);
+		return QColor::fromHsvF((1.0 - level) / 6.0, 0.85, 1.0,
+					0.3 + 0.6 * level);
+	}
+	case Qt::ForegroundRole:
+		if (count)
+			return QColor(Qt::black);
+		return QVariant();
+	}
+
+	return QVariant();
+}
+
+QVariant ScoreTableModel::headerData(int section, Qt::Orientation orientation,
+				     int role) const
+{
+	if (role != Qt::DisplayRole)
+		return QVariant();
+
+	// rows are labelled with the item number they start at, columns with
+	// how far along the row they are
+	if (orientation == Qt::Vertical)
+		return section * INSPECTOR_COLUMNS + 1;
+	return QString("+%1").arg(section);
+}
+
+void ScoreTableModel::reset()
+{
+	beginResetModel();
+
+	const ScoreTable &table = receiver->getScoreTable();
+	shown.assign(table.data(), table.capacity());
+	heat.assign(shown.size(), 0);
+	hottest = 0;
+	changes->clear();
+
+	endResetModel();
+}
+
+void ScoreTableModel::flushChanges()
+{
+	const ScoreTable &table = receiver->getScoreTable();
+
+	// resized with the configuration, so start over
+	if (table.capacity() != shown.size()) {
+		reset();
+		return;
+	}
+
+	for (auto &range : changes->ranges()) {
+		size_t end = std::min(range.second, shown.size());
+		size_t first = end, last = 0;
+
+		// a range can be written again with much of it unchanged, and
+		// only the bytes that really moved count towards the heatmap
+		for (size_t i = range.first; i < end; i++) {
+			if (shown[i] == table.data()[i])
+				continue;
+
+			shown[i] = table.data()[i];
+			hottest = std::max(hottest, ++heat[i]);
+			first = std::min(first, i);
+			last = i;
+		}
+
+		if (first < end)
+			emitRange(first, last + 1);
+	}
+	changes->clear();
+}
+
+void ScoreTableModel::emitRange(size_t begin, size_t end)
+{
+	int firstRow = (int)(begin / INSPECTOR_COLUMNS);
+	int lastRow = (int)((end - 1) / INSPECTOR_COLUMNS);
+
+	// within a row only the cells that changed, otherwise whole rows
+	if (firstRow == lastRow)
+		emit dataChanged(
+			index(firstRow, (int)(begin % INSPECTOR_COLUMNS)),
+			index(lastRow, (int)((end - 1) % INSPECTOR_COLUMNS)));
+	else
+		emit dataChanged(index(firstRow, 0),
+				 index(lastRow, INSPECTOR_COLUMNS - 1));
+}
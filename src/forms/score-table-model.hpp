@@ -0,0 +1,59 @@
+#ifndef ScoreTableModel_H
+#define ScoreTableModel_H
+
+#include <QAbstractTableModel>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "table-changes.hpp"
+
+// bytes shown on each row of the inspector
+#define INSPECTOR_COLUMNS 20
+
+// The receiver's score table laid out as a grid, with a count of how often
+// each byte has changed for the heatmap. Only the cells the view asks for
+// are ever looked at, and changes are checked against a copy of the table
+// and passed on as dataChanged a few times a second at most.
+class ScoreTableModel : public QAbstractTableModel {
+	Q_OBJECT
+
+public:
+	explicit ScoreTableModel(QObject *parent);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(
+		const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role) const override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+			    int role) const override;
+
+	// the zero-based table offset of a cell, which may be past the end
+	static inline size_t offsetOf(const QModelIndex &index)
+	{
+		return (size_t)index.row() * INSPECTOR_COLUMNS + index.column();
+	}
+
+	// picks up the table as it is now, and forgets the heatmap
+	void reset();
+
+	// changes are only followed while live
+	inline void setLive(bool live) { changes->setLive(live); }
+
+private slots:
+	void flushChanges();
+
+private:
+	TableChanges *changes;
+
+	// the table as of the last refresh, and how often each byte has
+	// changed since the heatmap was reset
+	std::string shown;
+	std::vector<uint32_t> heat;
+	uint32_t hottest;
+
+	void emitRange(size_t begin, size_t end);
+};
+
+#endif // ScoreTableModel_H
@@ -4,6 +4,7 @@
 #include <obs-module.h>
 #include <obs.hpp>
 
+#include <QFontDatabase>
 #include <QPushButton>
 
 #include <string>
@@ -11,6 +12,8 @@
 #include "settings.hpp"
 #include "ui_settings.h"
 
+#include "../plugin-macros.generated.h"
+
 #include "../receiver.hpp"
 
 extern Receiver *receiver;
@@ -31,8 +34,27 @@ Settings::Settings(QWidget *parent) : QDialog(parent), ui(new Ui::Settings)
 		&Settings::validate);
 	connect(ui->localAddr, &QLineEdit::textChanged, this,
 		&Settings::validate);
+	connect(ui->backupInputs, &QLineEdit::textChanged, this,
+		&Settings::validate);
+	connect(ui->relayPeers, &QLineEdit::textChanged, this,
+		&Settings::validate);
+	connect(ui->derivedFields, &QPlainTextEdit::textChanged, this,
+		&Settings::validate);
 	connect(ui->connectToUDS, &QCheckBox::stateChanged, this,
 		&Settings::connectToUDSChanged);
+
+	ui->protocol->addItem(T("OBSScoreboard.Settings.Protocol.RTD"),
+			      PROTOCOL_RTD);
+	ui->protocol->addItem(T("OBSScoreboard.Settings.Protocol.Line"),
+			      PROTOCOL_LINE);
+
+	ui->derivedFields->setFont(
+		QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+#ifndef __linux__
+	// the low-latency inputs are built on Linux socket options
+	ui->lowLatencyGroup->setVisible(false);
+#endif
 }
 
 Settings::~Settings()
@@ -66,6 +88,23 @@ void Settings::validate()
 	if (!QHostAddress().setAddress(ui->localAddr->text()))
 		ok = false;
 
+	std::vector<InputAddress> backups;
+	if (!parseInputList(ui->backupInputs->text(), backups))
+		ok = false;
+
+	std::vector<InputAddress> peers;
+	if (!parseInputList(ui->relayPeers->text(), peers))
+		ok = false;
+
+	// compiled here too, so the receiver never gets any that don't
+	DerivedFields derived;
+	std::string error;
+	if (!derived.compile(ui->derivedFields->toPlainText().toStdString(),
+			     error))
+		ok = false;
+	ui->derivedError->setText(QString::fromStdString(error));
+	ui->derivedError->setVisible(!error.empty());
+
 	ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ok);
 }
 
@@ -80,7 +119,24 @@ void Settings::okClicked()
 	receiver->udsPort = ui->udsPort->value();
 	receiver->listenAddr = QHostAddress(ui->localAddr->text());
 	receiver->listenPort = ui->localPort->value();
+	receiver->listenProtocol = ui->protocol->currentData().toUInt();
 	receiver->validateChecksums = ui->validateChecksums->isChecked();
+	receiver->tableSize = ui->tableSize->value();
+	receiver->recordSidecar = ui->recordSidecar->isChecked();
+	receiver->shmName = ui->shmName->text().trimmed();
+	parseInputList(ui->backupInputs->text(), receiver->backupInputs);
+	parseInputList(ui->relayPeers->text(), receiver->relayPeers);
+	receiver->derivedFields = ui->derivedFields->toPlainText();
+	receiver->lowLatency = ui->lowLatency->isChecked();
+	receiver->busyPollUs = ui->busyPoll->value();
+	receiver->cpuAffinity = ui->cpuAffinity->value();
+	receiver->realtimeThread = ui->realtimeThread->isChecked();
+	receiver->metricsPort = ui->metricsPort->value();
+	receiver->metricsFile = ui->metricsFile->text().trimmed();
+	receiver->priorityIntervals[PRIORITY_NORMAL] =
+		ui->normalInterval->value();
+	receiver->priorityIntervals[PRIORITY_LOW] = ui->lowInterval->value();
+	receiver->updateWorkers = ui->updateWorkers->value();
 
 	receiver->updateReceiver(enableReceiver);
 }
@@ -93,5 +149,23 @@ void Settings::resetValues()
 	ui->udsPort->setValue(receiver->udsPort);
 	ui->localAddr->setText(receiver->listenAddr.toString());
 	ui->localPort->setValue(receiver->listenPort);
+	ui->protocol->setCurrentIndex(
+		ui->protocol->findData(receiver->listenProtocol));
 	ui->validateChecksums->setChecked(receiver->validateChecksums);
+	ui->tableSize->setValue(receiver->tableSize);
+	ui->recordSidecar->setChecked(receiver->recordSidecar);
+	ui->shmName->setText(receiver->shmName);
+	ui->backupInputs->setText(formatInputList(receiver->backupInputs));
+	ui->relayPeers->setText(formatInputList(receiver->relayPeers));
+	ui->derivedFields->setPlainText(receiver->derivedFields);
+	ui->lowLatency->setChecked(receiver->lowLatency);
+	ui->busyPoll->setValue(receiver->busyPollUs);
+	ui->cpuAffinity->setValue(receiver->cpuAffinity);
+	ui->realtimeThread->setChecked(receiver->realtimeThread);
+	ui->metricsPort->setValue(receiver->metricsPort);
+	ui->metricsFile->setText(receiver->metricsFile);
+	ui->normalInterval->setValue(
+		receiver->priorityIntervals[PRIORITY_NORMAL]);
+	ui->lowInterval->setValue(receiver->priorityIntervals[PRIORITY_LOW]);
+	ui->updateWorkers->setValue(receiver->updateWorkers);
 }
@@ -0,0 +1,40 @@
+#include "table-changes.hpp"
+#include "../receiver.hpp"
+
+extern Receiver *receiver;
+
+TableChanges::TableChanges(int interval, QObject *parent) : QObject(parent)
+{
+	live = false;
+
+	refreshTimer = new QTimer(this);
+	refreshTimer->setSingleShot(true);
+	refreshTimer->setInterval(interval);
+	connect(refreshTimer, &QTimer::timeout, this, &TableChanges::due);
+}
+
+void TableChanges::setLive(bool live_)
+{
+	if (live == live_)
+		return;
+
+	live = live_;
+	changed.clear();
+
+	if (live) {
+		connect(receiver, &Receiver::tableChanged, this,
+			&TableChanges::tableChanged);
+	} else {
+		disconnect(receiver, &Receiver::tableChanged, this,
+			   &TableChanges::tableChanged);
+		refreshTimer->stop();
+	}
+}
+
+void TableChanges::tableChanged(size_t offset, size_t length)
+{
+	changed.emplace_back(offset, offset + length);
+
+	if (!refreshTimer->isActive())
+		refreshTimer->start();
+}
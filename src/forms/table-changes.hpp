@@ -0,0 +1,43 @@
+#ifndef TableChanges_H
+#define TableChanges_H
+
+#include <QObject>
+#include <QTimer>
+
+#include <utility>
+#include <vector>
+
+// Collects the ranges of the receiver's score table that change while live,
+// and says when it's time to show them: the first change after a refresh
+// starts the clock on the next one, so a busy feed can't swamp a view with
+// more than one refresh per interval.
+class TableChanges : public QObject {
+	Q_OBJECT
+
+public:
+	TableChanges(int interval, QObject *parent);
+
+	// changes are only followed while live
+	void setLive(bool live);
+
+	// [begin, end) ranges changed since they were last cleared
+	inline const std::vector<std::pair<size_t, size_t>> &ranges() const
+	{
+		return changed;
+	}
+	inline void clear() { changed.clear(); }
+
+signals:
+	// there are changes, and the interval is up
+	void due();
+
+private slots:
+	void tableChanged(size_t offset, size_t length);
+
+private:
+	bool live;
+	QTimer *refreshTimer;
+	std::vector<std::pair<size_t, size_t>> changed;
+};
+
+#endif // TableChanges_H
@@ -0,0 +1,254 @@
+#include <obs.h>
+#include <util/platform.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "low-latency.hpp"
+
+#include "plugin-macros.generated.h"
+
+#define LOW_LATENCY_MAX_DATAGRAM 65536
+
+// how often a blocked read wakes up to see whether it should stop
+#define LOW_LATENCY_WAKE_MS 100
+
+#define LOW_LATENCY_RT_PRIORITY 10
+
+LowLatencyInput::LowLatencyInput(Receiver *receiver_,
+				 const LowLatencyOptions &options_)
+{
+	receiver = receiver_;
+	options = options_;
+	fd = -1;
+	running = false;
+}
+
+#ifdef __linux__
+
+LowLatencyInput::~LowLatencyInput()
+{
+	running = false;
+	if (thread.joinable())
+		thread.join();
+	if (fd >= 0)
+		close(fd);
+}
+
+static socklen_t toSockaddr(const QHostAddress &addr, quint16 port,
+			    sockaddr_storage &out)
+{
+	memset(&out, 0, sizeof(out));
+
+	if (addr.protocol() == QAbstractSocket::IPv6Protocol) {
+		auto sin6 = (sockaddr_in6 *)&out;
+		sin6->sin6_family = AF_INET6;
+		sin6->sin6_port = htons(port);
+		Q_IPV6ADDR ip = addr.toIPv6Address();
+		memcpy(&sin6->sin6_addr, &ip, sizeof(sin6->sin6_addr));
+		return sizeof(*sin6);
+	}
+
+	auto sin = (sockaddr_in *)&out;
+	sin->sin_family = AF_INET;
+	sin->sin_port = htons(port);
+	sin->sin_addr.s_addr = htonl(addr.toIPv4Address());
+	return sizeof(*sin);
+}
+
+static bool joinGroup(int fd, const QHostAddress &group)
+{
+	if (group.protocol() == QAbstractSocket::IPv6Protocol) {
+		ipv6_mreq mreq = {};
+		Q_IPV6ADDR ip = group.toIPv6Address();
+		memcpy(&mreq.ipv6mr_multiaddr, &ip,
+		       sizeof(mreq.ipv6mr_multiaddr));
+		return setsockopt(fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq,
+				  sizeof(mreq)) == 0;
+	}
+
+	ip_mreq mreq = {};
+	mreq.imr_multiaddr.s_addr = htonl(group.toIPv4Address());
+	mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+	return setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq,
+			  sizeof(mreq)) == 0;
+}
+
+bool LowLatencyInput::open(const InputAddress &address)
+{
+	bool v6 = address.addr.protocol() == QAbstractSocket::IPv6Protocol;
+	bool multicast = address.addr.isMulticast();
+
+	// as with QUdpSocket, a group is joined on a shared wildcard bind
+	QHostAddress bindAddr = address.addr;
+	if (multicast)
+		bindAddr = v6 ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4;
+
+	fd = socket(v6 ? AF_INET6 : AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		blog(LOG_WARNING, "failed to create socket: %s",
+		     strerror(errno));
+		return false;
+	}
+
+	int on = 1;
+	if (multicast)
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0)
+		blog(LOG_WARNING, "kernel timestamps unavailable: %s",
+		     strerror(errno));
+
+	// raising this past net.core.busy_read needs CAP_NET_ADMIN
+	if (options.busy_poll_us) {
+		int us = (int)options.busy_poll_us;
+		if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &us, sizeof(us)) <
+		    0)
+			blog(LOG_WARNING, "failed to enable busy polling: %s",
+			     strerror(errno));
+	}
+
+	timeval timeout = {0, LOW_LATENCY_WAKE_MS * 1000};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	sockaddr_storage sa;
+	socklen_t len = toSockaddr(bindAddr, address.port, sa);
+
+	if (bind(fd, (sockaddr *)&sa, len) < 0 ||
+	    (multicast && !joinGroup(fd, address.addr))) {
+		blog(LOG_WARNING, "failed to bind %s:%d: %s",
+		     address.addr.toString().toUtf8().constData(),
+		     address.port, strerror(errno));
+		close(fd);
+		fd = -1;
+		return false;
+	}
+
+	boundName = address.addr.toString() + ':' +
+		    QString::number(address.port);
+	return true;
+}
+
+void LowLatencyInput::start(size_t input)
+{
+	running = true;
+	thread = std::thread(&LowLatencyInput::run, this, input);
+
+	pthread_t handle = thread.native_handle();
+	pthread_setname_np(handle, "obssb-receive");
+
+	if (options.cpu >= 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(options.cpu, &set);
+
+		int err = pthread_setaffinity_np(handle, sizeof(set), &set);
+		if (err)
+			blog(LOG_WARNING, "failed to pin receive thread: %s",
+			     strerror(err));
+	}
+
+	// needs CAP_SYS_NICE or an rtprio limit
+	if (options.realtime) {
+		sched_param param = {};
+		param.sched_priority = LOW_LATENCY_RT_PRIORITY;
+
+		int err = pthread_setschedparam(handle, SCHED_FIFO, &param);
+		if (err)
+			blog(LOG_WARNING,
+			     "failed to make receive thread realtime: %s",
+			     strerror(err));
+	}
+}
+
+// kernel timestamps are wall-clock; everything else here is monotonic
+static uint64_t kernelToMonotonic(const timespec &ts, uint64_t now)
+{
+	timespec wall;
+	clock_gettime(CLOCK_REALTIME, &wall);
+
+	int64_t waited = (int64_t)(wall.tv_sec - ts.tv_sec) * 1000000000 +
+			 (wall.tv_nsec - ts.tv_nsec);
+
+	// the wall clock can be stepped underneath us
+	if (waited < 0 || (uint64_t)waited > now)
+		return now;
+
+	return now - waited;
+}
+
+void LowLatencyInput::run(size_t input)
+{
+	std::vector<char> buf(LOW_LATENCY_MAX_DATAGRAM);
+	char control[CMSG_SPACE(sizeof(timespec))];
+
+	while (running.load(std::memory_order_relaxed)) {
+		iovec iov = {buf.data(), buf.size()};
+
+		msghdr msg = {};
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		ssize_t len = recvmsg(fd, &msg, 0);
+		if (len < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+			    errno == EINTR)
+				continue;
+
+			blog(LOG_ERROR, "receive failed: %s", strerror(errno));
+			break;
+		}
+
+		uint64_t arrival = os_gettime_ns();
+
+		for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+		     cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET ||
+			    cmsg->cmsg_type != SCM_TIMESTAMPNS)
+				continue;
+
+			timespec ts;
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			arrival = kernelToMonotonic(ts, arrival);
+		}
+
+		receiver->queueDatagram(input, std::string(buf.data(), len),
+					arrival);
+	}
+}
+
+#else
+
+LowLatencyInput::~LowLatencyInput() {}
+
+bool LowLatencyInput::open(const InputAddress &address)
+{
+	UNUSED_PARAMETER(address);
+
+	blog(LOG_WARNING, "low-latency inputs are only available on Linux");
+	return false;
+}
+
+void LowLatencyInput::start(size_t input)
+{
+	UNUSED_PARAMETER(input);
+}
+
+void LowLatencyInput::run(size_t input)
+{
+	UNUSED_PARAMETER(input);
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef OBSSB_LOW_LATENCY_HPP
+#define OBSSB_LOW_LATENCY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <QString>
+
+#include "receiver.hpp"
+
+struct LowLatencyOptions {
+	// busy-poll window in microseconds, 0 leaves it off
+	uint32_t busy_poll_us;
+	// CPU to pin the receive thread to, -1 for any
+	int cpu;
+	// run the receive thread under SCHED_FIFO
+	bool realtime;
+};
+
+// A UDP input read on a thread of its own through a plain socket instead of
+// QUdpSocket, so every datagram carries the kernel's arrival time and the
+// wait for the next one can be busy-polled. Datagrams are handed to the
+// receiver's thread with Receiver::queueDatagram. Linux only; elsewhere
+// open() fails.
+class LowLatencyInput {
+public:
+	LowLatencyInput(Receiver *receiver, const LowLatencyOptions &options);
+	~LowLatencyInput();
+
+	bool open(const InputAddress &address);
+
+	// starts the receive thread, feeding the given input
+	void start(size_t input);
+
+	inline const QString &name() const { return boundName; }
+
+private:
+	Receiver *receiver;
+	LowLatencyOptions options;
+	int fd;
+	QString boundName;
+
+	std::thread thread;
+	std::atomic<bool> running;
+
+	void run(size_t input);
+};
+
+#endif // OBSSB_LOW_LATENCY_HPP
@@ -0,0 +1,300 @@
+#include <obs.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+#include <QSaveFile>
+#include <QTcpSocket>
+
+#include "metrics.hpp"
+#include "receiver.hpp"
+
+#include "plugin-macros.generated.h"
+
+#define METRICS_PREFIX "obs_scoreboard_"
+#define METRICS_FILE_INTERVAL 5000
+
+// upper bounds of the histogram buckets, in nanoseconds
+static const uint64_t bucketBounds[METRICS_BUCKETS] = {
+	1000,    5000,    10000,   50000,    100000,
+	500000,  1000000, 5000000, 10000000, 50000000,
+};
+
+void Histogram::observe(uint64_t ns)
+{
+	for (int i = 0; i < METRICS_BUCKETS; i++) {
+		if (ns <= bucketBounds[i]) {
+			buckets[i]++;
+			break;
+		}
+	}
+	count++;
+	sum_ns += ns;
+}
+
+Metrics::Metrics(Receiver *receiver_) : QObject(receiver_)
+{
+	receiver = receiver_;
+	port = 0;
+	processFrame = Histogram{};
+	updateSources = Histogram{};
+	queueDelay = Histogram{};
+	applyDelay = Histogram{};
+	updatesIssued = 0;
+	updatesSkipped = 0;
+
+	server = new QTcpServer(this);
+	connect(server, &QTcpServer::newConnection, this,
+		&Metrics::newConnection);
+
+	fileTimer = new QTimer(this);
+	connect(fileTimer, &QTimer::timeout, this, &Metrics::writeFile);
+}
+
+void Metrics::configure(quint16 port_, const QString &file_)
+{
+	port = port_;
+	file = file_;
+
+	server->close();
+	// loopback only - this is for a local collector, not the network
+	if (port && !server->listen(QHostAddress::LocalHost, port))
+		blog(LOG_WARNING, "failed to listen for metrics on port %d: %s",
+		     port, server->errorString().toUtf8().constData());
+
+	if (file.isEmpty())
+		fileTimer->stop();
+	else
+		fileTimer->start(METRICS_FILE_INTERVAL);
+}
+
+void Metrics::countError(const char *reason)
+{
+	errors[reason]++;
+}
+
+void Metrics::countSourceUpdate(obs_source_t *source, uint64_t ns)
+{
+	SourceCost &cost = sources[obs_source_get_uuid(source)];
+	cost.name = obs_source_get_name(source);
+	cost.updates++;
+	cost.total_ns += ns;
+	updatesIssued++;
+}
+
+void Metrics::dropSource(const std::string &uuid)
+{
+	sources.erase(uuid);
+}
+
+void Metrics::keepSources(const std::vector<BindingPtr> &bindings)
+{
+	for (auto it = sources.begin(); it != sources.end();) {
+		bool bound = std::any_of(bindings.begin(), bindings.end(),
+					 [&](const BindingPtr &binding) {
+						 return binding->source_id ==
+							it->first;
+					 });
+		if (bound)
+			++it;
+		else
+			it = sources.erase(it);
+	}
+}
+
+void Metrics::countSuppressedChange(const Binding &binding)
+{
+	SuppressedChanges &entry = suppressed[binding.id];
+	entry.name = binding.name;
+	entry.changes++;
+}
+
+static std::string escapeLabel(const std::string &value)
+{
+	std::string escaped;
+	for (char c : value) {
+		if (c == '\\' || c == '"')
+			escaped += '\\';
+		if (c == '\n') {
+			escaped += "\\n";
+			continue;
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+static void renderHistogram(std::ostringstream &out, const char *name,
+			    const char *help, const Histogram &histogram)
+{
+	out << "# HELP " METRICS_PREFIX << name << ' ' << help << '\n';
+	out << "# TYPE " METRICS_PREFIX << name << " histogram\n";
+
+	unsigned long long cumulative = 0;
+	for (int i = 0; i < METRICS_BUCKETS; i++) {
+		cumulative += histogram.buckets[i];
+		out << METRICS_PREFIX << name << "_bucket{le=\""
+		    << bucketBounds[i] / 1e9 << "\"} " << cumulative << '\n';
+	}
+	out << METRICS_PREFIX << name << "_bucket{le=\"+Inf\"} "
+	    << histogram.count << '\n';
+	out << METRICS_PREFIX << name << "_sum " << histogram.sum_ns / 1e9
+	    << '\n';
+	out << METRICS_PREFIX << name << "_count " << histogram.count << '\n';
+}
+
+std::string Metrics::render() const
+{
+	std::ostringstream out;
+
+	out << "# HELP " METRICS_PREFIX "packets_total Datagrams received.\n"
+	    << "# TYPE " METRICS_PREFIX "packets_total counter\n"
+	    << METRICS_PREFIX "packets_total "
+	    << receiver->getCounter(COUNTER_PACKETS) << '\n';
+
+	out << "# HELP " METRICS_PREFIX "frames_total Valid frames received.\n"
+	    << "# TYPE " METRICS_PREFIX "frames_total counter\n"
+	    << METRICS_PREFIX "frames_total "
+	    << receiver->getCounter(COUNTER_FRAMES) << '\n';
+
+	out << "# HELP " METRICS_PREFIX
+	       "frame_errors_total Frames dropped, by reason.\n"
+	    << "# TYPE " METRICS_PREFIX "frame_errors_total counter\n";
+	for (auto &error : errors)
+		out << METRICS_PREFIX "frame_errors_total{reason=\""
+		    << escapeLabel(error.first) << "\"} " << error.second
+		    << '\n';
+
+	auto &inputs = receiver->getInputStats();
+	out << "# HELP " METRICS_PREFIX
+	       "input_frames_total Valid frames received per input.\n"
+	    << "# TYPE " METRICS_PREFIX "input_frames_total counter\n";
+	for (size_t i = 0; i < inputs.size(); i++)
+		out << METRICS_PREFIX "input_frames_total{input=\""
+		    << escapeLabel(receiver->inputName(i).toStdString())
+		    << "\"} " << inputs[i].frames << '\n';
+	out << "# HELP " METRICS_PREFIX
+	       "input_duplicates_total Frames another input delivered first.\n"
+	    << "# TYPE " METRICS_PREFIX "input_duplicates_total counter\n";
+	for (size_t i = 0; i < inputs.size(); i++)
+		out << METRICS_PREFIX "input_duplicates_total{input=\""
+		    << escapeLabel(receiver->inputName(i).toStdString())
+		    << "\"} " << inputs[i].duplicates << '\n';
+	out << "# HELP " METRICS_PREFIX
+	       "input_latency_seconds Smoothed delay behind the fastest input.\n"
+	    << "# TYPE " METRICS_PREFIX "input_latency_seconds gauge\n";
+	for (size_t i = 0; i < inputs.size(); i++)
+		out << METRICS_PREFIX "input_latency_seconds{input=\""
+		    << escapeLabel(receiver->inputName(i).toStdString())
+		    << "\"} " << inputs[i].latency_ms / 1e3 << '\n';
+	out << "# HELP " METRICS_PREFIX
+	       "input_relay_gaps_total Relay packets missed per input.\n"
+	    << "# TYPE " METRICS_PREFIX "input_relay_gaps_total counter\n";
+	for (size_t i = 0; i < inputs.size(); i++)
+		out << METRICS_PREFIX "input_relay_gaps_total{input=\""
+		    << escapeLabel(receiver->inputName(i).toStdString())
+		    << "\"} " << inputs[i].relay_gaps << '\n';
+	out << "# HELP " METRICS_PREFIX
+	       "input_rejected_total Out-of-bounds frames per input.\n"
+	    << "# TYPE " METRICS_PREFIX "input_rejected_total counter\n";
+	for (size_t i = 0; i < inputs.size(); i++)
+		out << METRICS_PREFIX "input_rejected_total{input=\""
+		    << escapeLabel(receiver->inputName(i).toStdString())
+		    << "\"} " << inputs[i].rejected << '\n';
+
+	renderHistogram(out, "process_frame_seconds",
+			"Time spent parsing and applying a frame.",
+			processFrame);
+	renderHistogram(out, "update_sources_seconds",
+			"Time spent applying bindings after a batch of packets.",
+			updateSources);
+	renderHistogram(out, "queue_delay_seconds",
+			"Time from kernel arrival until a datagram is handled.",
+			queueDelay);
+	renderHistogram(out, "apply_delay_seconds",
+			"Time from kernel arrival until sources are updated.",
+			applyDelay);
+
+	out << "# HELP " METRICS_PREFIX
+	       "source_updates_total Source updates issued by bindings.\n"
+	    << "# TYPE " METRICS_PREFIX "source_updates_total counter\n"
+	    << METRICS_PREFIX "source_updates_total " << updatesIssued << '\n';
+
+	out << "# HELP " METRICS_PREFIX
+	       "source_updates_skipped_total Bindings that needed no update.\n"
+	    << "# TYPE " METRICS_PREFIX "source_updates_skipped_total counter\n"
+	    << METRICS_PREFIX "source_updates_skipped_total " << updatesSkipped
+	    << '\n';
+
+	out << "# HELP " METRICS_PREFIX
+	       "source_update_seconds Time spent updating each source.\n"
+	    << "# TYPE " METRICS_PREFIX "source_update_seconds summary\n";
+	for (auto &source : sources) {
+		std::string labels = "{source=\"" +
+				     escapeLabel(source.second.name) +
+				     "\",uuid=\"" + source.first + "\"}";
+		out << METRICS_PREFIX "source_update_seconds_sum" << labels
+		    << ' ' << source.second.total_ns / 1e9 << '\n';
+		out << METRICS_PREFIX "source_update_seconds_count" << labels
+		    << ' ' << source.second.updates << '\n';
+	}
+
+	out << "# HELP " METRICS_PREFIX
+	       "suppressed_changes_total Changes held back by a binding's "
+	       "hold time or rate limit and never applied.\n"
+	    << "# TYPE " METRICS_PREFIX "suppressed_changes_total counter\n";
+	for (auto &binding : suppressed)
+		out << METRICS_PREFIX "suppressed_changes_total{binding=\""
+		    << escapeLabel(binding.second.name) << "\",id=\""
+		    << binding.first << "\"} " << binding.second.changes
+		    << '\n';
+
+	return out.str();
+}
+
+void Metrics::newConnection()
+{
+	while (QTcpSocket *client = server->nextPendingConnection()) {
+		connect(client, &QTcpSocket::disconnected, client,
+			&QObject::deleteLater);
+		connect(client, &QTcpSocket::readyRead, this, [this, client]() {
+			// only the request line matters; HTTP/1.0 closes after
+			if (!client->canReadLine())
+				return;
+
+			QList<QByteArray> request =
+				client->readLine().trimmed().split(' ');
+			bool found = request.size() >= 2 &&
+				     (request[1] == "/metrics" ||
+				      request[1] == "/");
+
+			std::string body = found ? render() : "not found\n";
+
+			QByteArray response = found ? "HTTP/1.0 200 OK\r\n"
+						    : "HTTP/1.0 404 Not Found\r\n";
+			response += "Content-Type: text/plain; version=0.0.4\r\n";
+			response += "Content-Length: " +
+				    QByteArray::number((qulonglong)body.size()) +
+				    "\r\n\r\n";
+			response.append(body.data(), (qsizetype)body.size());
+
+			client->write(response);
+			client->disconnectFromHost();
+		});
+	}
+}
+
+void Metrics::writeFile()
+{
+	// written aside and renamed into place, so readers never see half
+	QSaveFile out(file);
+	if (!out.open(QIODevice::WriteOnly)) {
+		blog(LOG_WARNING, "failed to write metrics to %s",
+		     file.toUtf8().constData());
+		return;
+	}
+
+	std::string body = render();
+	out.write(body.data(), (qint64)body.size());
+	out.commit();
+}
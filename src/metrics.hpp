@@ -0,0 +1,97 @@
+#ifndef OBSSB_METRICS_HPP
+#define OBSSB_METRICS_HPP
+
+#include <obs.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTimer>
+
+class Binding;
+class Receiver;
+
+typedef std::shared_ptr<const Binding> BindingPtr;
+
+#define METRICS_BUCKETS 10
+
+struct Histogram {
+	unsigned long long buckets[METRICS_BUCKETS];
+	unsigned long long count;
+	uint64_t sum_ns;
+
+	void observe(uint64_t ns);
+};
+
+struct SourceCost {
+	std::string name;
+	unsigned long long updates;
+	uint64_t total_ns;
+};
+
+struct SuppressedChanges {
+	std::string name;
+	unsigned long long changes;
+};
+
+// Counters and timings for the receive and update pipeline, exported in the
+// Prometheus text format over a loopback HTTP endpoint and/or a file that is
+// rewritten periodically. Everything here lives on the receiver's thread.
+class Metrics : public QObject {
+	Q_OBJECT
+
+public:
+	explicit Metrics(Receiver *receiver);
+
+	// a port of 0 or an empty path turns that export off
+	void configure(quint16 port, const QString &file);
+
+	inline void observeProcessFrame(uint64_t ns) { processFrame.observe(ns); }
+	inline void observeUpdateSources(uint64_t ns)
+	{
+		updateSources.observe(ns);
+	}
+	// from the kernel's arrival time, so only for low-latency inputs
+	inline void observeQueueDelay(uint64_t ns) { queueDelay.observe(ns); }
+	inline void observeApplyDelay(uint64_t ns) { applyDelay.observe(ns); }
+	inline void countSkippedUpdate() { updatesSkipped++; }
+	// a change a binding held back and never applied
+	void countSuppressedChange(const Binding &binding);
+	void countError(const char *reason);
+	void countSourceUpdate(obs_source_t *source, uint64_t ns);
+	// a source's costs go once it's gone, or nothing's bound to it, so
+	// the sources that come and go in a session don't pile up
+	void dropSource(const std::string &uuid);
+	void keepSources(const std::vector<BindingPtr> &bindings);
+
+	std::string render() const;
+
+private slots:
+	void newConnection();
+	void writeFile();
+
+private:
+	Receiver *receiver;
+	quint16 port;
+	QString file;
+	QTcpServer *server;
+	QTimer *fileTimer;
+
+	Histogram processFrame;
+	Histogram updateSources;
+	Histogram queueDelay;
+	Histogram applyDelay;
+	unsigned long long updatesIssued;
+	unsigned long long updatesSkipped;
+	std::map<std::string, unsigned long long> errors;
+	std::map<std::string, SourceCost> sources;
+	// by binding id, which a rename doesn't change
+	std::map<std::string, SuppressedChanges> suppressed;
+};
+
+#endif // OBSSB_METRICS_HPP
@@ -0,0 +1,139 @@
+/*
+ * The score table as exported to POSIX shared memory, for programs on the
+ * same machine (a separate graphics renderer, say) that want it without a
+ * feed of their own. The segment is named in the plugin's settings, e.g.
+ * "obs-scoreboard" is opened as shm_open("/obs-scoreboard", O_RDONLY, 0).
+ *
+ * The segment is a header followed by the table, header_size bytes in:
+ *
+ *     struct obssb_shm_header | table (max_table bytes)
+ *
+ * The plugin writes it under a seqlock. seq is even while everything under
+ * it is consistent and odd while it's being written, so a read is taken as
+ *
+ *     do {
+ *             seq = obssb_shm_read_begin(header);
+ *             ... copy what's wanted out of the segment ...
+ *     } while (obssb_shm_read_retry(header, seq));
+ *
+ * and nothing read in between is to be trusted until the loop ends. Each
+ * write bumps version and logs the ranges it changed, the last
+ * OBSSB_SHM_LOG_SIZE of which are kept: entry n of log_count is at
+ * log[n % OBSSB_SHM_LOG_SIZE]. A reader further behind than that has to
+ * take the whole table again.
+ *
+ * On Linux seq is also a futex, woken on every write, so readers can sleep
+ * until something changes with obssb_shm_wait() instead of polling. That
+ * needs syscall() and struct timespec, which strict C modes (-std=c99,
+ * -std=c11) hide: define _GNU_SOURCE before any system header, or include
+ * this one first and it does so itself. Before glibc 2.34, shm_open() also
+ * needs linking with -lrt.
+ *
+ * When the export is turned off or OBS exits, closed is set and the segment
+ * unlinked; a new one is created under the same name when it's turned on
+ * again, which readers have to open afresh.
+ *
+ * Fields are in the machine's byte order, and only readable with the
+ * __atomic builtins of GCC and Clang.
+ */
+
+#ifndef OBS_SCOREBOARD_SHM_H
+#define OBS_SCOREBOARD_SHM_H
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* a system header came first, in a strict mode, so it's too late */
+#if defined(__GLIBC__) && !defined(__USE_MISC)
+#error "define _GNU_SOURCE before any system header for obssb_shm_wait()"
+#endif
+#endif
+
+/* "OBSB" */
+#define OBSSB_SHM_MAGIC 0x4253424fu
+#define OBSSB_SHM_LAYOUT 1
+
+#define OBSSB_SHM_LOG_SIZE 256
+
+struct obssb_shm_range {
+	/* the version that wrote it */
+	uint64_t version;
+	/* zero-based, so item number - 1 */
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct obssb_shm_header {
+	uint32_t magic;
+	uint32_t layout;
+	/* where the table starts, from the start of the segment */
+	uint32_t header_size;
+	/* room for the table, which is as much as it can ever hold */
+	uint32_t max_table;
+
+	/* the seqlock; the rest is only meaningful under it */
+	uint32_t seq;
+	uint32_t closed;
+
+	/* how much of the table is in use */
+	uint32_t capacity;
+	uint32_t reserved;
+	/* counts writes */
+	uint64_t version;
+	/* when the last write was made, by CLOCK_MONOTONIC */
+	uint64_t updated_ns;
+	/* ranges ever logged */
+	uint64_t log_count;
+	struct obssb_shm_range log[OBSSB_SHM_LOG_SIZE];
+};
+
+static inline const char *
+obssb_shm_table(const struct obssb_shm_header *header)
+{
+	return (const char *)header + header->header_size;
+}
+
+static inline uint32_t
+obssb_shm_read_begin(const struct obssb_shm_header *header)
+{
+	uint32_t seq;
+
+	while ((seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE)) & 1)
+		;
+	return seq;
+}
+
+/* nonzero if the segment was written during the read, which is then void */
+static inline int obssb_shm_read_retry(const struct obssb_shm_header *header,
+				       uint32_t seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&header->seq, __ATOMIC_RELAXED) != seq;
+}
+
+#ifdef __linux__
+/*
+ * sleeps until seq is no longer the one given, or for at most timeout_ms;
+ * it can also return early for no reason, like any futex wait
+ */
+static inline void obssb_shm_wait(const struct obssb_shm_header *header,
+				  uint32_t seq, int timeout_ms)
+{
+	struct timespec timeout;
+
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+	syscall(SYS_futex, &header->seq, FUTEX_WAIT, seq, &timeout, NULL, 0);
+}
+#endif
+
+#endif /* OBS_SCOREBOARD_SHM_H */
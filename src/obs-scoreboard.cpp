@@ -22,12 +22,18 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <QMainWindow>
 #include <QAction>
 #include <QMenu>
+#include <QFileDialog>
 
 #include "receiver.hpp"
+#include "recorder.hpp"
+#include "scoreboard-text.hpp"
+#include "trace.hpp"
 #include "forms/settings.hpp"
 #include "forms/help-about.hpp"
 #include "forms/manage-bindings.hpp"
 #include "forms/configure-binding.hpp"
+#include "forms/inspector.hpp"
+#include "forms/profiler.hpp"
 
 #include "plugin-macros.generated.h"
 
@@ -39,6 +45,8 @@ Settings *settings;
 HelpAbout *helpAbout;
 ManageBindings *bindings;
 ConfigureBinding *config;
+Inspector *inspector;
+Profiler *profiler;
 Receiver *receiver;
 
 const char *obs_module_name()
@@ -51,21 +59,64 @@ const char *obs_module_description()
 	return "Integration to bind scoreboard information into OBS Sources";
 }
 
+static void frontendEvent(enum obs_frontend_event event, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	switch (event) {
+	case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+		receiver->start();
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+		receiver->sceneCollectionChanged();
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_RENAMED:
+		receiver->sceneCollectionRenamed();
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_STARTED:
+		receiver->recorder->recordingStarted();
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_STOPPED:
+		receiver->recorder->recordingStopped();
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_PAUSED:
+		receiver->recorder->recordingPaused();
+		break;
+	case OBS_FRONTEND_EVENT_RECORDING_UNPAUSED:
+		receiver->recorder->recordingUnpaused();
+		break;
+	case OBS_FRONTEND_EVENT_EXIT:
+		receiver->shutdown();
+		break;
+	default:
+		break;
+	}
+}
+
 bool obs_module_load()
 {
 	blog(LOG_INFO, "Hello! (%s)", PLUGIN_VERSION);
 
+	// sources have to be registered even without a frontend, or scenes
+	// that use them won't load
+	register_scoreboard_text_source();
+
 	QMainWindow *mainWindow = (QMainWindow *)obs_frontend_get_main_window();
 	if (!mainWindow)
 		return true;
 
+	// the config and the sockets can wait until OBS is up
 	receiver = new Receiver();
+	obs_frontend_add_event_callback(frontendEvent, nullptr);
 
 	obs_frontend_push_ui_translation(obs_module_get_string);
 	settings = new Settings(mainWindow);
 	helpAbout = new HelpAbout(mainWindow);
-	bindings = new ManageBindings(mainWindow);
+	// the binding list follows the binding dialog, so that comes first
 	config = new ConfigureBinding(mainWindow);
+	bindings = new ManageBindings(mainWindow);
+	inspector = new Inspector(mainWindow);
+	profiler = new Profiler(mainWindow);
 	obs_frontend_pop_ui_translation();
 
 	QMenu *menu = new QMenu(T("OBSScoreboard.Menu"), mainWindow);
@@ -87,6 +138,41 @@ bool obs_module_load()
 			 &ManageBindings::toggleVisible);
 	menu->addAction(bindingsAction);
 
+	QAction *inspectorAction =
+		new QAction(T("OBSScoreboard.Menu.Inspector"), menu);
+	QObject::connect(inspectorAction, &QAction::triggered, inspector,
+			 &Inspector::toggleVisible);
+	menu->addAction(inspectorAction);
+
+	QAction *profilerAction =
+		new QAction(T("OBSScoreboard.Menu.Profiler"), menu);
+	QObject::connect(profilerAction, &QAction::triggered, profiler,
+			 &Profiler::toggleVisible);
+	menu->addAction(profilerAction);
+
+#ifdef ENABLE_TRACING
+	menu->addSeparator();
+
+	QAction *traceAction = new QAction(T("OBSScoreboard.Menu.Trace"), menu);
+	traceAction->setCheckable(true);
+	QObject::connect(traceAction, &QAction::toggled, &traceSetEnabled);
+	menu->addAction(traceAction);
+
+	QAction *saveTraceAction =
+		new QAction(T("OBSScoreboard.Menu.SaveTrace"), menu);
+	QObject::connect(saveTraceAction, &QAction::triggered, [mainWindow]() {
+		QString path = QFileDialog::getSaveFileName(
+			mainWindow, T("OBSScoreboard.Menu.SaveTrace"),
+			"obs-scoreboard-trace.json", "JSON (*.json)");
+		if (path.isEmpty())
+			return;
+		if (!traceDump(path.toUtf8().constData()))
+			blog(LOG_WARNING, "failed to write trace to %s",
+			     path.toUtf8().constData());
+	});
+	menu->addAction(saveTraceAction);
+#endif
+
 	QAction *toolsQAction = (QAction *)obs_frontend_add_tools_menu_qaction(
 		T("OBSScoreboard.Menu"));
 	toolsQAction->setMenu(menu);
@@ -98,5 +184,10 @@ void obs_module_unload()
 {
 	delete settings;
 
+	// the text sources read from it until they're gone, which they are
+	// by now
+	delete receiver;
+	receiver = nullptr;
+
 	blog(LOG_INFO, "Goodbye!");
 }
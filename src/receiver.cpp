@@ -1,14 +1,30 @@
 #include <util/dstr.hpp>
 #include <util/config-file.h>
+#include <util/platform.h>
 #include <obs-frontend-api.h>
 #include <obs.hpp>
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
 #include <exception>
 
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QUrl>
+#include <QUuid>
 
 #include "receiver.hpp"
+#include "decoders.hpp"
+#include "relay.hpp"
+#include "recorder.hpp"
+#include "shm-export.hpp"
+#include "update-pool.hpp"
+#include "low-latency.hpp"
+#include "trace.hpp"
 
 #include "plugin-macros.generated.h"
 
@@ -20,11 +36,35 @@
 #define CFG_UDS_PORT "udsPort"
 #define CFG_LISTEN_ADDR "ListenAddr"
 #define CFG_LISTEN_PORT "ListenPort"
+#define CFG_LISTEN_PROTOCOL "ListenProtocol"
 #define CFG_VALIDATE_CHECKSUMS "ValidateChecksums"
+#define CFG_BACKUP_INPUTS "BackupInputs"
+#define CFG_TABLE_SIZE "ScoreTableSize"
+#define CFG_RELAY_PEERS "RelayPeers"
+#define CFG_LOW_LATENCY "LowLatency"
+#define CFG_BUSY_POLL "BusyPollUs"
+#define CFG_CPU_AFFINITY "CpuAffinity"
+#define CFG_REALTIME_THREAD "RealtimeThread"
+#define CFG_METRICS_PORT "MetricsPort"
+#define CFG_METRICS_FILE "MetricsFile"
+#define CFG_NORMAL_INTERVAL "NormalPriorityInterval"
+#define CFG_LOW_INTERVAL "LowPriorityInterval"
+#define CFG_RECORD_SIDECAR "RecordSidecar"
+#define CFG_SHM_NAME "ShmName"
+#define CFG_UPDATE_WORKERS "UpdateWorkers"
+#define CFG_DERIVED_FIELDS "DerivedFields"
 #define CFG_BINDINGS_JSON "BindingsJSON"
 
 #define BINDINGS_JSON_KEY "bindings"
 
+// each scene collection's bindings are kept in a file of their own here,
+// under the module's config directory
+#define BINDINGS_DIR "bindings"
+
+// scene collections whose binding lists are kept for switching back to
+#define BINDING_CACHE_SIZE 4
+
+#define BINDING_ID "id"
 #define BINDING_ENABLED "enabled"
 #define BINDING_NAME "name"
 #define BINDING_ITEMNO "item_number"
@@ -35,9 +75,45 @@
 #define BINDING_TRIM_STR "trim_str"
 #define BINDING_INVERT_BOOL "invert_bool"
 #define BINDING_FLAG_VALUE "flag_value"
+#define BINDING_TARGET_TYPE "target_type"
+#define BINDING_SCENE_ITEM "scene_item"
+#define BINDING_ALT_SCENE_ITEM "alt_scene_item"
+#define BINDING_CLOCK_MODE "clock_mode"
+#define BINDING_PRIORITY "priority"
+#define BINDING_HOLD_MS "hold_ms"
+#define BINDING_HOLD_UPDATES "hold_updates"
+#define BINDING_MIN_INTERVAL "min_interval_ms"
+#define BINDING_TABLE_ROWS "table_rows"
+#define BINDING_TABLE_STRIDE "table_stride"
+#define BINDING_TABLE_COLUMNS "table_columns"
+
+// how long a batch of lower priority bindings may run before it yields
+#define BATCH_BUDGET_NS 2000000ULL
+
+// the last known score table, kept in the plugin's config directory so a
+// restart mid-game doesn't leave every overlay blank
+#define SNAPSHOT_FILE "score-snapshot.bin"
+#define SNAPSHOT_MAGIC 0x5342534fU
+#define SNAPSHOT_CAPACITY SCORE_TABLE_MAX_CAPACITY
+#define SNAPSHOT_INTERVAL 1000
+
+// anything older than this is from another game
+#define SNAPSHOT_MAX_AGE_MS (4LL * 60 * 60 * 1000)
+
+struct SnapshotHeader {
+	uint32_t magic;
+	uint32_t length;
+	int64_t written_ms;
+};
+
+static std::string newBindingId()
+{
+	return QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
+}
 
 Binding::Binding()
 {
+	id = newBindingId();
 	enabled = false;
 	name = obs_module_text("OBSScoreboard.Bindings.NewName");
 	item_number = 1;
@@ -47,10 +123,23 @@ Binding::Binding()
 	trim_str = false;
 	invert_bool = false;
 	flag_value = 0;
+	target_type = TARGET_PROPERTY;
+	scene_item_id = 0;
+	alt_scene_item_id = 0;
+	clock_mode = false;
+	priority = PRIORITY_IMMEDIATE;
+	hold_ms = 0;
+	hold_updates = 0;
+	min_interval_ms = 0;
 }
 
 Binding::Binding(obs_data_t *json)
 {
+	// missing from older configs, and saved from here on
+	id = obs_data_get_string(json, BINDING_ID);
+	if (id.empty())
+		id = newBindingId();
+
 	enabled = obs_data_get_bool(json, BINDING_ENABLED);
 	name = obs_data_get_string(json, BINDING_NAME);
 	item_number = obs_data_get_int(json, BINDING_ITEMNO);
@@ -70,12 +159,59 @@ Binding::Binding(obs_data_t *json)
 	trim_str = obs_data_get_bool(json, BINDING_TRIM_STR);
 	invert_bool = obs_data_get_bool(json, BINDING_INVERT_BOOL);
 	flag_value = obs_data_get_int(json, BINDING_FLAG_VALUE);
+
+	// missing from older configs, in which case this is a property binding
+	target_type = obs_data_get_int(json, BINDING_TARGET_TYPE);
+	scene_item_id = obs_data_get_int(json, BINDING_SCENE_ITEM);
+	alt_scene_item_id = obs_data_get_int(json, BINDING_ALT_SCENE_ITEM);
+	clock_mode = obs_data_get_bool(json, BINDING_CLOCK_MODE);
+
+	// older configs don't have one, and everything was applied immediately
+	priority = obs_data_get_int(json, BINDING_PRIORITY);
+	if (priority >= PRIORITY_COUNT)
+		priority = PRIORITY_IMMEDIATE;
+
+	// missing from older configs, in which case every change goes through
+	hold_ms = obs_data_get_int(json, BINDING_HOLD_MS);
+	hold_updates = obs_data_get_int(json, BINDING_HOLD_UPDATES);
+	min_interval_ms = obs_data_get_int(json, BINDING_MIN_INTERVAL);
+
+	// blocks are only shown as text
+	if (target_type == TARGET_PROPERTY) {
+		table.rows = std::clamp<long long>(
+			obs_data_get_int(json, BINDING_TABLE_ROWS), 0,
+			TABLE_MAX_ROWS);
+		table.stride = std::clamp<long long>(
+			obs_data_get_int(json, BINDING_TABLE_STRIDE), 0,
+			TABLE_MAX_STRIDE);
+		if (!table.parseColumns(obs_data_get_string(
+			    json, BINDING_TABLE_COLUMNS))) {
+			blog(LOG_WARNING,
+			     "binding %s has invalid table columns",
+			     name.c_str());
+			table.rows = 0;
+		}
+		if (table.isTable()) {
+			field_length = table.span();
+			clock_mode = false;
+		}
+	}
+
+	// the table is sized from the bindings, so one that runs off the end
+	// can't be allowed in
+	if (enabled && !inBounds()) {
+		blog(LOG_WARNING,
+		     "disabling binding %s: item %u, length %u is out of range",
+		     name.c_str(), item_number, field_length);
+		enabled = false;
+	}
 }
 
 obs_data_t *Binding::toJSON() const
 {
 	obs_data_t *json = obs_data_create();
 
+	obs_data_set_string(json, BINDING_ID, id.c_str());
 	obs_data_set_bool(json, BINDING_ENABLED, enabled);
 	obs_data_set_string(json, BINDING_NAME, name.c_str());
 	obs_data_set_int(json, BINDING_ITEMNO, item_number);
@@ -96,17 +232,53 @@ obs_data_t *Binding::toJSON() const
 
 	obs_data_set_int(json, BINDING_FLAG_VALUE, flag_value);
 
+	obs_data_set_int(json, BINDING_TARGET_TYPE, target_type);
+	obs_data_set_int(json, BINDING_SCENE_ITEM, scene_item_id);
+	obs_data_set_int(json, BINDING_ALT_SCENE_ITEM, alt_scene_item_id);
+	obs_data_set_bool(json, BINDING_CLOCK_MODE, clock_mode);
+	obs_data_set_int(json, BINDING_PRIORITY, priority);
+	obs_data_set_int(json, BINDING_HOLD_MS, hold_ms);
+	obs_data_set_int(json, BINDING_HOLD_UPDATES, hold_updates);
+	obs_data_set_int(json, BINDING_MIN_INTERVAL, min_interval_ms);
+	obs_data_set_int(json, BINDING_TABLE_ROWS, table.rows);
+	obs_data_set_int(json, BINDING_TABLE_STRIDE, table.stride);
+	obs_data_set_string(json, BINDING_TABLE_COLUMNS,
+			    table.formatColumns().c_str());
+
 	return json;
 }
 
-void Binding::resetSource()
+bool Binding::inBounds() const
 {
-	enabled = false;
-	source_id = "";
-	parent_prop = {};
-	trim_str = false;
-	invert_bool = false;
-	flag_value = 0;
+	return item_number >= 1 && field_length >= 1 &&
+	       field_length <= SCORE_TABLE_MAX_CAPACITY &&
+	       item_number - 1 <= SCORE_TABLE_MAX_CAPACITY - field_length;
+}
+
+static std::string currentCollection()
+{
+	char *name = obs_frontend_get_current_scene_collection();
+	std::string out = name ? name : "";
+	bfree(name);
+	return out;
+}
+
+// where a scene collection's bindings are saved, or empty if there's nowhere
+static std::string bindingsPath(const std::string &collection)
+{
+	if (collection.empty())
+		return std::string();
+
+	// names can hold anything, including slashes
+	QByteArray file = BINDINGS_DIR "/" +
+			  QUrl::toPercentEncoding(
+				  QString::fromStdString(collection)) +
+			  ".json";
+
+	char *path = obs_module_config_path(file.constData());
+	std::string out = path ? path : "";
+	bfree(path);
+	return out;
 }
 
 Receiver::Receiver()
@@ -114,13 +286,83 @@ Receiver::Receiver()
 	for (auto &counter : counters)
 		counter = 0;
 
+	// interpolated clocks are redrawn once per output frame
+	obs_video_info ovi;
+	int clockInterval = 33;
+	if (obs_get_video_info(&ovi) && ovi.fps_num)
+		clockInterval = 1000 * ovi.fps_den / ovi.fps_num;
+
+	clockTimer = new QTimer(this);
+	connect(clockTimer, &QTimer::timeout, this, &Receiver::updateClocks);
+	clockTimer->start(clockInterval);
+
+	holdTimer = new QTimer(this);
+	holdTimer->setSingleShot(true);
+	connect(holdTimer, &QTimer::timeout, this, &Receiver::recheckHeld);
+
+	priorityIntervals[PRIORITY_IMMEDIATE] = 0;
+	priorityIntervals[PRIORITY_NORMAL] = 250;
+	priorityIntervals[PRIORITY_LOW] = 1000;
+
+	for (uint32_t priority = 0; priority < PRIORITY_COUNT; priority++) {
+		batchCursor[priority] = 0;
+
+		// immediate bindings go straight from socketReady
+		if (priority == PRIORITY_IMMEDIATE) {
+			priorityTimers[priority] = nullptr;
+			continue;
+		}
+
+		priorityTimers[priority] = new QTimer(this);
+		connect(priorityTimers[priority], &QTimer::timeout, this,
+			[this, priority]() {
+				// an unfinished batch carries on by itself
+				if (batchCursor[priority] == 0)
+					updateSources(priority);
+			});
+		priorityTimers[priority]->start(priorityIntervals[priority]);
+	}
+
 	// set up defaults - if a config is found, these will be overwritten later
 	udsAddr = QHostAddress::Null;
 	udsPort = 20999;
 	listenAddr = QHostAddress::Any;
 	listenPort = 21000;
-	socket = nullptr;
+	listenProtocol = PROTOCOL_RTD;
 	validateChecksums = true;
+	tableSize = SCORE_TABLE_DEFAULT_CAPACITY;
+	lastPrune = 0;
+	metricsPort = 0;
+	metrics = new Metrics(this);
+	relay = new Relay(this);
+	recordSidecar = false;
+	recorder = new Recorder(this);
+	shmExport = new ShmExport(this);
+	updateWorkers = 0;
+	updatePool = new UpdatePool(this);
+	lowLatency = false;
+	busyPollUs = 0;
+	cpuAffinity = -1;
+	realtimeThread = false;
+	arrivalNs = 0;
+	loaded = false;
+	sharedMigrated = false;
+	collectionSwitches = 0;
+	snapshotFile = nullptr;
+	snapshot = nullptr;
+	snapshotDirty = false;
+	snapshotTimer = nullptr;
+
+	bindings = std::make_shared<const BindingSet>(BindingSet{0, {}});
+	activeBindings = bindings;
+
+	profile.reset(os_gettime_ns());
+	resizeTable();
+}
+
+void Receiver::start()
+{
+	openSnapshot();
 
 	config_t *config = obs_frontend_get_global_config();
 
@@ -133,9 +375,12 @@ Receiver::Receiver()
 			break;
 		}
 	}
+	collection = currentCollection();
+
 	if (!scoreboardSectionExists) {
 		blog(LOG_WARNING, "No configuration for " PLUGIN_NAME
 				  " found. Falling back to defaults.");
+		loaded = true;
 		return;
 	}
 
@@ -151,39 +396,390 @@ Receiver::Receiver()
 	listenAddr = QHostAddress(
 		config_get_string(config, CFG_SECTION, CFG_LISTEN_ADDR));
 	listenPort = config_get_uint(config, CFG_SECTION, CFG_LISTEN_PORT);
+	listenProtocol =
+		config_get_uint(config, CFG_SECTION, CFG_LISTEN_PROTOCOL);
+	if (listenProtocol >= PROTOCOL_COUNT)
+		listenProtocol = PROTOCOL_RTD;
 	validateChecksums =
 		config_get_bool(config, CFG_SECTION, CFG_VALIDATE_CHECKSUMS);
 
-	// load binding list
-	const char *bindings_b64 =
-		config_get_string(config, CFG_SECTION, CFG_BINDINGS_JSON);
-	auto bindingsJSON = QByteArray::fromBase64(bindings_b64);
-	OBSDataAutoRelease bindingsObj =
-		obs_data_create_from_json(bindingsJSON.constData());
-	OBSDataArrayAutoRelease bindingsArr =
-		obs_data_get_array(bindingsObj, BINDINGS_JSON_KEY);
+	// missing from older configs, in which case the default stands
+	uint64_t size = config_get_uint(config, CFG_SECTION, CFG_TABLE_SIZE);
+	if (size)
+		tableSize = std::min<uint64_t>(size, SCORE_TABLE_MAX_CAPACITY);
+
+	const char *backups =
+		config_get_string(config, CFG_SECTION, CFG_BACKUP_INPUTS);
+	if (backups && !parseInputList(backups, backupInputs))
+		blog(LOG_WARNING, "ignoring invalid backup inputs: %s", backups);
+
+	const char *peers =
+		config_get_string(config, CFG_SECTION, CFG_RELAY_PEERS);
+	if (peers && !parseInputList(peers, relayPeers))
+		blog(LOG_WARNING, "ignoring invalid relay peers: %s", peers);
+
+	lowLatency = config_get_bool(config, CFG_SECTION, CFG_LOW_LATENCY);
+	busyPollUs = config_get_uint(config, CFG_SECTION, CFG_BUSY_POLL);
+	realtimeThread =
+		config_get_bool(config, CFG_SECTION, CFG_REALTIME_THREAD);
+	if (config_has_user_value(config, CFG_SECTION, CFG_CPU_AFFINITY))
+		cpuAffinity =
+			config_get_int(config, CFG_SECTION, CFG_CPU_AFFINITY);
+
+	metricsPort = config_get_uint(config, CFG_SECTION, CFG_METRICS_PORT);
+	metricsFile = config_get_string(config, CFG_SECTION, CFG_METRICS_FILE);
+
+	recordSidecar =
+		config_get_bool(config, CFG_SECTION, CFG_RECORD_SIDECAR);
+	shmName = config_get_string(config, CFG_SECTION, CFG_SHM_NAME);
+	updateWorkers =
+		config_get_uint(config, CFG_SECTION, CFG_UPDATE_WORKERS);
+
+	// one definition per line, so it's kept encoded like the bindings
+	derivedFields = QString::fromUtf8(QByteArray::fromBase64(
+		config_get_string(config, CFG_SECTION, CFG_DERIVED_FIELDS)));
+
+	// missing from older configs, in which case the defaults stand
+	uint64_t normalInterval =
+		config_get_uint(config, CFG_SECTION, CFG_NORMAL_INTERVAL);
+	if (normalInterval)
+		priorityIntervals[PRIORITY_NORMAL] = normalInterval;
+	uint64_t lowInterval =
+		config_get_uint(config, CFG_SECTION, CFG_LOW_INTERVAL);
+	if (lowInterval)
+		priorityIntervals[PRIORITY_LOW] = lowInterval;
+
+	loadBindings([this, enableReceiver]() {
+		updateReceiver(enableReceiver);
+	});
+}
+
+void Receiver::loadBindings(std::function<void()> done)
+{
+	loaded = false;
+
+	// one load at a time; a load for a collection that's since been
+	// left is thrown away when it's done
+	if (loader.joinable())
+		loader.join();
+
+	std::string name = collection;
+	std::string path = bindingsPath(name);
+	uint64_t generation = collectionSwitches;
+
+	// the list older versions shared between all collections moves into
+	// the first one loaded after upgrading, if it hasn't a file of its
+	// own, and no other; without a collection it's still the only list
+	bool migrate = !path.empty() && !sharedMigrated;
+	sharedMigrated = sharedMigrated || migrate;
+
+	config_t *config = obs_frontend_get_global_config();
+	QByteArray shared_b64;
+	if (path.empty() || migrate)
+		shared_b64 = config_get_string(config, CFG_SECTION,
+					       CFG_BINDINGS_JSON);
+
+	// the binding list can be large, so it's parsed on a thread of its
+	// own and handed back here when it's ready
+	loader = std::thread([this, name, path, generation, shared_b64, migrate,
+			      done]() {
+		auto parsed = std::make_shared<std::vector<BindingPtr>>();
+
+		OBSDataAutoRelease bindingsObj;
+		if (!path.empty())
+			bindingsObj = obs_data_create_from_json_file_safe(
+				path.c_str(), "bak");
+
+		// the shared list is only dropped once it's safely in the
+		// collection's file
+		bool migrated = migrate &&
+				(bindingsObj || shared_b64.isEmpty());
+		if (!bindingsObj && !shared_b64.isEmpty()) {
+			auto bindingsJSON = QByteArray::fromBase64(shared_b64);
+			bindingsObj = obs_data_create_from_json(
+				bindingsJSON.constData());
+		}
+		if (migrate && !migrated && bindingsObj) {
+			QDir().mkpath(QFileInfo(QString::fromStdString(path))
+					      .absolutePath());
+			migrated = obs_data_save_json_safe(
+				bindingsObj, path.c_str(), "tmp", "bak");
+			if (migrated)
+				blog(LOG_INFO,
+				     "moved shared bindings to scene "
+				     "collection %s",
+				     name.c_str());
+		}
+		OBSDataArrayAutoRelease bindingsArr =
+			obs_data_get_array(bindingsObj, BINDINGS_JSON_KEY);
+
+		size_t bindingsCount = obs_data_array_count(bindingsArr);
+		for (size_t i = 0; i < bindingsCount; i++) {
+			OBSDataAutoRelease item =
+				obs_data_array_item(bindingsArr, i);
+			parsed->push_back(
+				std::make_shared<const Binding>(item));
+		}
+
+		QMetaObject::invokeMethod(
+			this,
+			[this, generation, parsed, migrated, done]() {
+				bindingsLoaded(generation, *parsed, migrated,
+					       done);
+			},
+			Qt::QueuedConnection);
+	});
+}
+
+void Receiver::bindingsLoaded(uint64_t generation,
+			      std::vector<BindingPtr> &loadedBindings,
+			      bool migrated, const std::function<void()> &done)
+{
+	// whichever collection is current, the shared list has found a home
+	if (migrated) {
+		config_t *config = obs_frontend_get_global_config();
+		config_remove_value(config, CFG_SECTION, CFG_BINDINGS_JSON);
+		config_save(config);
+	}
+
+	// switched to another collection while this one was loading; it
+	// may only have been renamed, in which case it's still the one
+	if (generation != collectionSwitches)
+		return;
+
+	// keep anything that was added while we were loading
+	BindingSetPtr current = getBindings();
+	loadedBindings.insert(loadedBindings.end(), current->bindings.begin(),
+			      current->bindings.end());
+	publishBindings(std::move(loadedBindings));
+	loaded = true;
+
+	if (done)
+		done();
+
+	switchedBindings();
+}
+
+void Receiver::sceneCollectionChanged()
+{
+	std::string name = currentCollection();
+	if (collection.empty() || name == collection)
+		return;
+
+	// anything still waiting to be saved belongs to the collection we're
+	// leaving, and its list is kept for coming back to, unless we're
+	// leaving before it was even loaded
+	saveConfig();
+	if (loaded)
+		cacheBindings(collection, getBindings()->bindings);
+
+	blog(LOG_INFO, "switching bindings to scene collection %s",
+	     name.c_str());
+	collection = name;
+	collectionSwitches++;
+
+	auto cached = std::find_if(bindingCache.begin(), bindingCache.end(),
+				   [&](const CachedBindings &entry) {
+					   return entry.collection == name;
+				   });
+
+	// the bindings are immutable, so the list is as good as new
+	if (cached != bindingCache.end()) {
+		publishBindings(cached->bindings);
+		loaded = true;
+		switchedBindings();
+		return;
+	}
+
+	// none of the old collection's bindings apply to this one's sources
+	publishBindings({});
+	emit bindingsSwitched();
+	loadBindings(nullptr);
+}
+
+void Receiver::sceneCollectionRenamed()
+{
+	std::string name = currentCollection();
+	if (collection.empty() || name == collection)
+		return;
+
+	// not while it's being read
+	if (loader.joinable())
+		loader.join();
+
+	// the file goes with it, replacing any left by a collection that
+	// had the name before
+	QString from = QString::fromStdString(bindingsPath(collection));
+	QString to = QString::fromStdString(bindingsPath(name));
+	for (const char *ext : {"", ".bak"}) {
+		if (!QFile::exists(from + ext))
+			continue;
+		QFile::remove(to + ext);
+		if (!QFile::rename(from + ext, to + ext))
+			blog(LOG_WARNING, "failed to rename %s",
+			     (from + ext).toUtf8().constData());
+	}
 
-	size_t bindingsCount = obs_data_array_count(bindingsArr);
-	for (size_t i = 0; i < bindingsCount; i++) {
-		OBSDataAutoRelease item = obs_data_array_item(bindingsArr, i);
-		bindings.emplace_back(item);
+	blog(LOG_INFO, "scene collection %s renamed to %s",
+	     collection.c_str(), name.c_str());
+
+	for (auto &entry : bindingCache) {
+		if (entry.collection == collection)
+			entry.collection = name;
 	}
+	collection = name;
+
+	// whatever couldn't be moved is saved afresh
+	saveConfig();
+}
 
-	updateReceiver(enableReceiver);
+void Receiver::cacheBindings(const std::string &name,
+			     const std::vector<BindingPtr> &list)
+{
+	bindingCache.erase(std::remove_if(bindingCache.begin(),
+					  bindingCache.end(),
+					  [&](const CachedBindings &entry) {
+						  return entry.collection ==
+							 name;
+					  }),
+			   bindingCache.end());
+
+	bindingCache.insert(bindingCache.begin(), CachedBindings{name, list});
+	if (bindingCache.size() > BINDING_CACHE_SIZE)
+		bindingCache.resize(BINDING_CACHE_SIZE);
+}
+
+void Receiver::switchedBindings()
+{
+	emit bindingsSwitched();
+
+	// the sources are new, so everything is applied to them straight
+	// away, filled in from the snapshot if nothing's arrived yet
+	for (uint32_t priority = 0; priority < PRIORITY_COUNT; priority++)
+		updateSources(priority);
 }
 
 Receiver::~Receiver()
 {
-	if (socket)
-		delete socket;
+	shutdown();
+}
+
+void Receiver::shutdown()
+{
+	if (loader.joinable())
+		loader.join();
+
+	closeInputs();
+
+	// a recording that's still going gets its index and trailer, while
+	// the table is here to finish it from
+	recorder->recordingStopped();
+
+	// readers see closed, and the segment doesn't outlive OBS
+	shmExport->configure(QString());
+
+	// nothing more is applied from here on
+	clockTimer->stop();
+	holdTimer->stop();
+	for (auto timer : priorityTimers) {
+		if (timer)
+			timer->stop();
+	}
+
+	// what's still queued gets to its sources while they're around
+	updatePool->configure(0);
+
+	for (auto &uuid : watchedSources) {
+		OBSSourceAutoRelease source =
+			obs_get_source_by_uuid(uuid.c_str());
+		if (!source)
+			continue;
+
+		signal_handler_t *sh = obs_source_get_signal_handler(source);
+		signal_handler_disconnect(sh, "show", &Receiver::sourceShown,
+					  this);
+		signal_handler_disconnect(sh, "activate",
+					  &Receiver::sourceShown, this);
+		signal_handler_disconnect(sh, "destroy",
+					  &Receiver::sourceDestroyed, this);
+	}
+	watchedSources.clear();
+}
+
+static const char *protocolNames[PROTOCOL_COUNT] = {"rtd", "line"};
+
+bool parseInputList(const QString &str, std::vector<InputAddress> &out)
+{
+	out.clear();
+
+	for (auto &entry : str.split(',', Qt::SkipEmptyParts)) {
+		QString trimmed = entry.trimmed();
+		uint32_t protocol = PROTOCOL_RTD;
+
+		int at = trimmed.lastIndexOf('@');
+		if (at >= 0) {
+			QString name = trimmed.mid(at + 1).trimmed();
+			trimmed = trimmed.left(at).trimmed();
+
+			protocol = 0;
+			while (protocol < PROTOCOL_COUNT &&
+			       name.compare(protocolNames[protocol],
+					    Qt::CaseInsensitive) != 0)
+				protocol++;
+
+			if (protocol == PROTOCOL_COUNT)
+				return false;
+		}
+
+		int sep = trimmed.lastIndexOf(':');
+		if (sep <= 0)
+			return false;
+
+		// IPv6 addresses have to be bracketed to carry a port
+		QString addr = trimmed.left(sep);
+		if (addr.startsWith('[') && addr.endsWith(']'))
+			addr = addr.mid(1, addr.length() - 2);
+
+		bool ok;
+		uint port = trimmed.mid(sep + 1).toUInt(&ok);
+		InputAddress input{QHostAddress(addr), (quint16)port, protocol};
+
+		if (!ok || port == 0 || port > 65535 || input.addr.isNull())
+			return false;
+
+		out.push_back(input);
+	}
+
+	return true;
+}
+
+QString formatInputList(const std::vector<InputAddress> &inputs)
+{
+	QStringList list;
+
+	for (auto &input : inputs) {
+		QString addr = input.addr.toString();
+		if (input.addr.protocol() == QAbstractSocket::IPv6Protocol)
+			addr = '[' + addr + ']';
+		addr += ':' + QString::number(input.port);
+		if (input.protocol != PROTOCOL_RTD)
+			addr += QString('@') + protocolNames[input.protocol];
+		list.append(addr);
+	}
+
+	return list.join(", ");
 }
 
 void Receiver::saveConfig() const
 {
+	// until the bindings are in, saving would throw them away
+	if (!loaded)
+		return;
+
 	config_t *config = obs_frontend_get_global_config();
 
 	config_set_bool(config, CFG_SECTION, CFG_RECEIVER_RUNNING,
-			socket != nullptr);
+			inputCount() > 0);
 	config_set_bool(config, CFG_SECTION, CFG_CONNECT_TO_UDS,
 			!udsAddr.isNull());
 	if (!udsAddr.isNull()) {
@@ -194,12 +790,38 @@ void Receiver::saveConfig() const
 	config_set_string(config, CFG_SECTION, CFG_LISTEN_ADDR,
 			  listenAddr.toString().toUtf8().constData());
 	config_set_uint(config, CFG_SECTION, CFG_LISTEN_PORT, listenPort);
+	config_set_uint(config, CFG_SECTION, CFG_LISTEN_PROTOCOL,
+			listenProtocol);
 	config_set_bool(config, CFG_SECTION, CFG_VALIDATE_CHECKSUMS,
 			validateChecksums);
+	config_set_uint(config, CFG_SECTION, CFG_TABLE_SIZE, tableSize);
+	config_set_string(config, CFG_SECTION, CFG_BACKUP_INPUTS,
+			  formatInputList(backupInputs).toUtf8().constData());
+	config_set_string(config, CFG_SECTION, CFG_RELAY_PEERS,
+			  formatInputList(relayPeers).toUtf8().constData());
+	config_set_bool(config, CFG_SECTION, CFG_LOW_LATENCY, lowLatency);
+	config_set_uint(config, CFG_SECTION, CFG_BUSY_POLL, busyPollUs);
+	config_set_int(config, CFG_SECTION, CFG_CPU_AFFINITY, cpuAffinity);
+	config_set_bool(config, CFG_SECTION, CFG_REALTIME_THREAD,
+			realtimeThread);
+	config_set_uint(config, CFG_SECTION, CFG_METRICS_PORT, metricsPort);
+	config_set_string(config, CFG_SECTION, CFG_METRICS_FILE,
+			  metricsFile.toUtf8().constData());
+	config_set_bool(config, CFG_SECTION, CFG_RECORD_SIDECAR, recordSidecar);
+	config_set_string(config, CFG_SECTION, CFG_SHM_NAME,
+			  shmName.toUtf8().constData());
+	config_set_uint(config, CFG_SECTION, CFG_UPDATE_WORKERS,
+			updateWorkers);
+	config_set_string(config, CFG_SECTION, CFG_DERIVED_FIELDS,
+			  derivedFields.toUtf8().toBase64().constData());
+	config_set_uint(config, CFG_SECTION, CFG_NORMAL_INTERVAL,
+			priorityIntervals[PRIORITY_NORMAL]);
+	config_set_uint(config, CFG_SECTION, CFG_LOW_INTERVAL,
+			priorityIntervals[PRIORITY_LOW]);
 
 	OBSDataArrayAutoRelease bindingsArr = obs_data_array_create();
-	for (auto binding : bindings) {
-		OBSDataAutoRelease bindingObj = binding.toJSON();
+	for (auto &binding : getBindings()->bindings) {
+		OBSDataAutoRelease bindingObj = binding->toJSON();
 		obs_data_array_push_back(bindingsArr, bindingObj);
 	}
 
@@ -208,10 +830,21 @@ void Receiver::saveConfig() const
 	// add the array and release - the library has it from here
 	obs_data_set_array(bindingsObj, BINDINGS_JSON_KEY, bindingsArr);
 
-	// serialize and save
-	QByteArray json = obs_data_get_json(bindingsObj);
-	std::string b64 = json.toBase64().toStdString();
-	config_set_string(config, CFG_SECTION, CFG_BINDINGS_JSON, b64.c_str());
+	// without a scene collection there's only the shared list
+	std::string path = bindingsPath(collection);
+	if (path.empty()) {
+		QByteArray json = obs_data_get_json(bindingsObj);
+		std::string b64 = json.toBase64().toStdString();
+		config_set_string(config, CFG_SECTION, CFG_BINDINGS_JSON,
+				  b64.c_str());
+	} else {
+		QDir().mkpath(QFileInfo(QString::fromStdString(path))
+				      .absolutePath());
+		if (!obs_data_save_json_safe(bindingsObj, path.c_str(), "tmp",
+					     "bak"))
+			blog(LOG_WARNING, "failed to save bindings to %s",
+			     path.c_str());
+	}
 
 	config_save(config);
 }
@@ -219,37 +852,320 @@ void Receiver::saveConfig() const
 void Receiver::updateReceiver(bool enabled)
 {
 	blog(LOG_INFO, "updating server (%s)", enabled ? "ON" : "OFF");
-	if (socket) {
-		delete socket;
-		socket = nullptr;
+	closeInputs();
+	inputStats.clear();
+	recentFrames.clear();
+	latestFrames.clear();
+
+	// the settings dialog won't take definitions that don't compile, but
+	// the config file can be edited by hand
+	std::string error;
+	if (!derived.compile(derivedFields.toStdString(), error))
+		blog(LOG_WARNING, "keeping previous derived fields: %s",
+		     error.c_str());
+
+	resizeTable();
+	derived.markAll();
+	updateDerived();
+
+	// metrics stay up while the receiver is off, so the outage shows
+	metrics->configure(metricsPort, metricsFile);
+
+	// as is the export, which keeps the last table it had
+	shmExport->configure(shmName);
+	shmExport->flush();
+
+	updatePool->configure(updateWorkers);
+
+	// pick up changed intervals
+	for (uint32_t priority = 0; priority < PRIORITY_COUNT; priority++) {
+		if (priorityTimers[priority])
+			priorityTimers[priority]->start(
+				priorityIntervals[priority]);
 	}
 
-	if (!enabled)
+	if (!enabled) {
+		relay->configure({});
+		saveConfig();
 		return;
+	}
 
-	socket = new QUdpSocket(this);
-	connect(socket, &QIODevice::readyRead, this, &Receiver::socketReady);
-	connect(socket, &QAbstractSocket::errorOccurred, this,
-		&Receiver::socketError);
-	if (!socket->bind(listenAddr, listenPort)) {
+	std::vector<InputAddress> addresses = {
+		{listenAddr, listenPort, listenProtocol}};
+	addresses.insert(addresses.end(), backupInputs.begin(),
+			 backupInputs.end());
+
+	for (auto &address : addresses) {
+		if (bindInput(address))
+			continue;
+
+		// a backup that can't bind shouldn't take down the main feed
+		if (inputCount() > 0) {
+			blog(LOG_WARNING, "failed to bind backup input %s:%d",
+			     address.addr.toString().toUtf8().constData(),
+			     address.port);
+			continue;
+		}
+
+		// not modal, so a bad config can't hold up the rest of OBS
 		QMainWindow *mainWindow =
 			(QMainWindow *)obs_frontend_get_main_window();
-		QMessageBox::critical(mainWindow,
-				      T("OBSScoreboard.Error.Critical"),
-				      T("OBSScoreboard.Error.BindFailed"));
-		delete socket;
-		socket = nullptr;
+		QMessageBox *box =
+			new QMessageBox(QMessageBox::Critical,
+					T("OBSScoreboard.Error.Critical"),
+					T("OBSScoreboard.Error.BindFailed"),
+					QMessageBox::Ok, mainWindow);
+		box->setAttribute(Qt::WA_DeleteOnClose);
+		box->open();
 		return;
 	}
-	if (!udsAddr.isNull()) {
-		socket->connectToHost(udsAddr, udsPort);
+
+	inputStats.resize(inputCount(), InputStats{});
+
+	// the threads only start once there are stats for them to fill in
+	for (size_t i = 0; i < lowLatencyInputs.size(); i++)
+		lowLatencyInputs[i]->start(i);
+
+	if (!udsAddr.isNull() && !sockets.empty()) {
+		sockets[0]->connectToHost(udsAddr, udsPort);
 	}
 
+	relay->configure(relayPeers);
+
 	saveConfig();
 }
 
+BindingSetPtr Receiver::getBindings() const
+{
+	return std::atomic_load(&bindings);
+}
+
+BindingSetPtr Receiver::publishBindings(std::vector<BindingPtr> list)
+{
+	auto set = std::make_shared<BindingSet>();
+	set->version = getBindings()->version + 1;
+	set->bindings = std::move(list);
+	std::atomic_store(&bindings, BindingSetPtr(set));
+
+	// grown straight away so frames for a new field aren't turned away,
+	// but it can't shrink until the update path lets go of the old set
+	resizeTable();
+	return set;
+}
+
+void Receiver::replaceBinding(const BindingPtr &old, const BindingPtr &binding)
+{
+	std::vector<BindingPtr> list = getBindings()->bindings;
+
+	// removed while it was being edited, but the edit is still wanted
+	auto it = std::find(list.begin(), list.end(), old);
+	if (it == list.end())
+		list.push_back(binding);
+	else
+		*it = binding;
+
+	publishBindings(std::move(list));
+}
+
+void Receiver::carryState(const BindingPtr &old, const BindingPtr &binding)
+{
+	carriedStates[binding.get()] = old;
+}
+
+void Receiver::adoptBindings()
+{
+	BindingSetPtr latest = getBindings();
+	if (latest == activeBindings)
+		return;
+
+	// state carries over for bindings that are still there, unedited
+	std::unordered_map<const Binding *, size_t> previous;
+	for (size_t i = 0; i < activeBindings->bindings.size(); i++)
+		previous[activeBindings->bindings[i].get()] = i;
+
+	std::vector<size_t> moved(latest->bindings.size(), SIZE_MAX);
+	std::vector<BindingState> states(latest->bindings.size());
+	for (size_t i = 0; i < latest->bindings.size(); i++) {
+		// or for ones that were copied, perhaps more than once
+		const Binding *binding = latest->bindings[i].get();
+		auto it = previous.find(binding);
+		for (auto carried = carriedStates.find(binding);
+		     it == previous.end() && carried != carriedStates.end();
+		     carried = carriedStates.find(binding)) {
+			binding = carried->second.get();
+			it = previous.find(binding);
+		}
+
+		if (it != previous.end()) {
+			states[i] = std::move(bindingStates[it->second]);
+			moved[i] = it->second;
+			previous.erase(it);
+		}
+	}
+	carriedStates.clear();
+
+	// batches that are part way through carry on from the first of their
+	// bindings still to do that's still there
+	for (size_t &cursor : batchCursor) {
+		if (!cursor)
+			continue;
+
+		size_t next = latest->bindings.size();
+		for (size_t i = 0; i < moved.size(); i++) {
+			if (moved[i] != SIZE_MAX && moved[i] >= cursor &&
+			    (next == latest->bindings.size() ||
+			     moved[i] < moved[next]))
+				next = i;
+		}
+		cursor = next;
+	}
+
+	blog(LOG_DEBUG, "switching to binding set %" PRIu64 " (%zu bindings)",
+	     latest->version, latest->bindings.size());
+
+	bindingStates.swap(states);
+	activeBindings = latest;
+	metrics->keepSources(latest->bindings);
+
+	// the old set may have been holding the table open
+	resizeTable();
+}
+
+void Receiver::resizeTable()
+{
+	// covers both the set being published and the one still being
+	// updated from, which are only different in between passes
+	size_t capacity = std::max<size_t>(tableSize, derived.extent());
+	for (auto set : {getBindings(), activeBindings}) {
+		if (!set)
+			continue;
+
+		for (auto &binding : set->bindings) {
+			if (!binding->inBounds())
+				continue;
+
+			size_t end = binding->item_number - 1 +
+				     binding->field_length;
+			capacity = std::max(capacity, end);
+		}
+	}
+
+	if (capacity == scoreTable.capacity())
+		return;
+
+	blog(LOG_INFO, "score table holds %zu bytes", capacity);
+
+	std::lock_guard<std::mutex> lock(scoreMutex);
+	scoreTable.resize(capacity);
+	profile.resize(scoreTable.capacity());
+}
+
+ProfileReport Receiver::profileReport() const
+{
+	// the set being updated from, which has the suppressed counts
+	std::vector<unsigned long long> suppressed;
+	for (auto &state : bindingStates)
+		suppressed.push_back(state.suppressed);
+
+	return buildProfileReport(profile, *activeBindings, suppressed,
+				  os_gettime_ns());
+}
+
+void Receiver::resetProfile()
+{
+	profile.reset(os_gettime_ns());
+	for (auto &state : bindingStates)
+		state.suppressed = 0;
+}
+
+bool Receiver::bindInput(const InputAddress &address)
+{
+	if (lowLatency) {
+		LowLatencyOptions options;
+		options.busy_poll_us = busyPollUs;
+		options.cpu = cpuAffinity;
+		options.realtime = realtimeThread;
+
+		LowLatencyInput *input = new LowLatencyInput(this, options);
+		if (input->open(address)) {
+			lowLatencyInputs.push_back(input);
+			inputProtocols.push_back(address.protocol);
+			return true;
+		}
+
+		delete input;
+		return false;
+	}
+
+	QUdpSocket *socket = new QUdpSocket(this);
+	connect(socket, &QIODevice::readyRead, this, &Receiver::socketReady);
+	connect(socket, &QAbstractSocket::errorOccurred, this,
+		&Receiver::socketError);
+
+	// a multicast group is joined on top of a wildcard bind, which may be
+	// shared with other listeners on the same machine
+	bool multicast = address.addr.isMulticast();
+	QHostAddress bindAddr = address.addr;
+	QAbstractSocket::BindMode bindMode =
+		QAbstractSocket::DefaultForPlatform;
+	if (multicast) {
+		bool v6 = address.addr.protocol() ==
+			  QAbstractSocket::IPv6Protocol;
+		bindAddr = v6 ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4;
+		bindMode = QAbstractSocket::ShareAddress |
+			   QAbstractSocket::ReuseAddressHint;
+	}
+
+	if (socket->bind(bindAddr, address.port, bindMode) &&
+	    (!multicast || socket->joinMulticastGroup(address.addr))) {
+		sockets.push_back(socket);
+		inputProtocols.push_back(address.protocol);
+		return true;
+	}
+
+	delete socket;
+	return false;
+}
+
+void Receiver::closeInputs()
+{
+	for (auto socket : sockets)
+		delete socket;
+	sockets.clear();
+
+	// joins the threads, so nothing more gets queued after this
+	for (auto input : lowLatencyInputs)
+		delete input;
+	lowLatencyInputs.clear();
+	inputProtocols.clear();
+
+	std::lock_guard<std::mutex> lock(queueMutex);
+	datagramQueue.clear();
+}
+
+QString Receiver::inputName(size_t input) const
+{
+	if (input < lowLatencyInputs.size())
+		return lowLatencyInputs[input]->name();
+	if (input >= sockets.size())
+		return QString();
+
+	QUdpSocket *socket = sockets[input];
+	return socket->localAddress().toString() + ':' +
+	       QString::number(socket->localPort());
+}
+
 void Receiver::socketReady()
 {
+	TRACE_ZONE("socketReady");
+
+	auto socket = qobject_cast<QUdpSocket *>(sender());
+	auto it = std::find(sockets.begin(), sockets.end(), socket);
+	if (it == sockets.end())
+		return;
+
+	size_t input = it - sockets.begin();
+
 	// process all available datagrams
 	while (socket->hasPendingDatagrams()) {
 		qint64 len = socket->pendingDatagramSize();
@@ -260,163 +1176,451 @@ void Receiver::socketReady()
 
 		std::string_view data(buf, len);
 
-		processDatagram(data);
+		processDatagram(data, input);
 
 		delete[] buf;
 	}
 
-	// no need to update sources until we've dealt with all pending packets
-	updateSources();
+	// derived fields once for the whole batch, however many packets
+	// touched them
+	updateDerived();
+
+	// pass on everything that changed in this batch in one go
+	relay->flush();
+	shmExport->flush();
+
+	// no need to update sources until we've dealt with all pending packets;
+	// lower priorities wait for their own timers
+	updateSources(PRIORITY_IMMEDIATE);
 }
 
 void Receiver::socketError(QAbstractSocket::SocketError err)
 {
-	auto msg = socket->errorString().toUtf8().constData();
-	blog(LOG_ERROR, "Socket error: %s (%d)", msg, err);
+	auto socket = qobject_cast<QUdpSocket *>(sender());
+	auto msg = socket->errorString().toUtf8();
+	blog(LOG_ERROR, "Socket error: %s (%d)", msg.constData(), err);
 }
 
-#define SYN '\x16'
-#define SOH '\x01'
-#define STX '\x02'
-#define EOT '\x04'
-#define ETB '\x17'
+void Receiver::queueDatagram(size_t input, std::string &&data,
+			     uint64_t arrival_ns)
+{
+	bool wake;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		wake = datagramQueue.empty();
+		datagramQueue.push_back({input, std::move(data), arrival_ns});
+	}
 
-#define IS_CONTROL_CHAR(c) (c < 0x20)
+	// one wakeup covers everything that arrives before it's handled
+	if (wake)
+		QMetaObject::invokeMethod(
+			this, [this]() { drainQueue(); }, Qt::QueuedConnection);
+}
 
-void Receiver::processDatagram(const std::string_view &data)
+void Receiver::drainQueue()
 {
-	std::string_view::iterator begin = data.begin();
+	TRACE_ZONE("drainQueue");
 
-	for (auto it = data.begin(); it != data.end(); it++) {
-		switch (*it) {
-		case SYN:
-			begin = it;
-			break;
-		case ETB:
-			std::string_view frame(data.data() +
-						       (begin - data.begin()),
-					       it - begin);
-			const char *error = processFrame(frame);
-
-			if (!error) {
-				incrementCounter(COUNTER_FRAMES);
-				break;
-			}
-
-			blog(LOG_WARNING, "dropping frame: %s (packet: %s)",
-			     error,
-			     QByteArray(frame.data(), frame.size())
-				     .toBase64()
-				     .constData());
-
-			incrementCounter(COUNTER_ERRORS);
-			break;
-		}
+	drainBuffer.clear();
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		drainBuffer.swap(datagramQueue);
+	}
+
+	if (drainBuffer.empty())
+		return;
+
+	uint64_t earliest = UINT64_MAX;
+
+	for (auto &datagram : drainBuffer) {
+		// left over from before the inputs were rebuilt
+		if (datagram.input >= inputStats.size())
+			continue;
+
+		metrics->observeQueueDelay(os_gettime_ns() -
+					   datagram.arrival_ns);
+		earliest = std::min(earliest, datagram.arrival_ns);
+
+		arrivalNs = datagram.arrival_ns;
+		processDatagram(datagram.data, datagram.input);
+	}
+	arrivalNs = 0;
+
+	updateDerived();
+	relay->flush();
+	shmExport->flush();
+	updateSources(PRIORITY_IMMEDIATE);
+
+	if (earliest != UINT64_MAX)
+		metrics->observeApplyDelay(os_gettime_ns() - earliest);
+}
+
+// frames seen again within this window are the same frame from another input
+#define DEDUP_WINDOW_NS 1000000000ULL
+
+// frames are remembered for this long, so one that an input lagging behind
+// the others delivers after its field has moved on isn't applied again
+#define STALE_WINDOW_NS 10000000000ULL
+
+// weight given to each new latency sample
+#define LATENCY_SMOOTHING 0.1
+
+static uint64_t hashFrame(size_t offset, const std::string_view &body)
+{
+	// FNV-1a over the offset and the body
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto mix = [&hash](uint8_t byte) {
+		hash ^= byte;
+		hash *= 0x100000001b3ULL;
+	};
+
+	for (size_t i = 0; i < sizeof(offset); i++)
+		mix((uint8_t)(offset >> (i * 8)));
+	for (char c : body)
+		mix((uint8_t)c);
+
+	return hash;
+}
+
+bool Receiver::isDuplicate(size_t input, size_t offset,
+			   const std::string_view &body)
+{
+	// the kernel's arrival time, if we have it, leaves our own queueing
+	// out of the latency between inputs
+	uint64_t now = arrivalNs ? arrivalNs : os_gettime_ns();
+	InputStats &stats = inputStats[input];
+
+	stats.frames++;
+	stats.last_ns = now;
+
+	// nothing to compare against with a single input
+	if (inputCount() < 2)
+		return false;
+
+	pruneRecentFrames(now);
+
+	uint64_t hash = hashFrame(offset, body);
+	auto seen = recentFrames.find(hash);
+	auto latest = latestFrames.find(offset);
+
+	// already applied and since replaced by a frame this input hasn't
+	// delivered yet, so it's behind the others and the frame is stale
+	// however long it took to get here. Once it has delivered the newer
+	// one, the field really has gone back.
+	bool stale = false;
+	if (seen != recentFrames.end() && latest != latestFrames.end() &&
+	    latest->second != hash) {
+		auto newer = recentFrames.find(latest->second);
+		stale = newer != recentFrames.end() &&
+			input < newer->second.deliveries.size() &&
+			newer->second.deliveries[input] == 0;
+	}
+	if (stale) {
+		stats.duplicates++;
+		double latency = (now - seen->second.first_ns) / 1000000.0;
+		stats.latency_ms +=
+			(latency - stats.latency_ms) * LATENCY_SMOOTHING;
+		return true;
+	}
+
+	RecentFrame &frame = recentFrames[hash];
+	if (frame.deliveries.size() != inputCount() ||
+	    now - frame.last_ns > DEDUP_WINDOW_NS)
+		frame.deliveries.assign(inputCount(), 0);
+
+	frame.last_ns = now;
+
+	// the console repeats frames, so count deliveries per input. This one
+	// is a duplicate if another input has already delivered it as often.
+	uint32_t delivered = ++frame.deliveries[input];
+	uint32_t elsewhere = 0;
+	for (size_t i = 0; i < frame.deliveries.size(); i++) {
+		if (i != input)
+			elsewhere = std::max(elsewhere, frame.deliveries[i]);
+	}
+
+	double latency = 0.0;
+	bool duplicate = delivered <= elsewhere;
+
+	if (duplicate) {
+		stats.duplicates++;
+		latency = (now - frame.first_ns) / 1000000.0;
+	} else {
+		stats.first++;
+		frame.first_ns = now;
+		latestFrames[offset] = hash;
+	}
+
+	stats.latency_ms += (latency - stats.latency_ms) * LATENCY_SMOOTHING;
+
+	return duplicate;
+}
+
+void Receiver::pruneRecentFrames(uint64_t now)
+{
+	if (now - lastPrune < DEDUP_WINDOW_NS)
+		return;
+
+	lastPrune = now;
+
+	for (auto it = recentFrames.begin(); it != recentFrames.end();) {
+		if (now - it->second.last_ns > STALE_WINDOW_NS)
+			it = recentFrames.erase(it);
+		else
+			++it;
+	}
+}
+
+struct Receiver::DecoderSink {
+	Receiver *receiver;
+	size_t input;
+	uint64_t start;
+
+	inline const char *write(size_t offset, const std::string_view &data)
+	{
+		return receiver->applyRange(input, offset, data);
+	}
+
+	inline void frame()
+	{
+		finish();
+		receiver->incrementCounter(COUNTER_FRAMES);
+	}
+
+	inline void error(const char *reason, const std::string_view &raw)
+	{
+		finish();
+
+		blog(LOG_WARNING, "dropping frame: %s (packet: %s)", reason,
+		     QByteArray(raw.data(), raw.size()).toBase64().constData());
+
+		receiver->incrementCounter(COUNTER_ERRORS);
+		receiver->metrics->countError(reason);
+	}
+
+	// each frame is timed from the end of the one before it
+	inline void finish()
+	{
+		uint64_t now = os_gettime_ns();
+		receiver->metrics->observeProcessFrame(now - start);
+		start = now;
+	}
+};
+
+void Receiver::processDatagram(const std::string_view &data, size_t input)
+{
+	TRACE_ZONE("processDatagram");
+
+	// another instance relaying its feed to us, which can't be mistaken
+	// for any of the console protocols
+	if (isRelayPacket(data)) {
+		processRelayPacket(data, input);
+		incrementCounter(COUNTER_PACKETS);
+		return;
+	}
+
+	DecoderSink sink{this, input, os_gettime_ns()};
+
+	// the only per-datagram choice; the decoders are specialized below it
+	switch (inputProtocols[input]) {
+	case PROTOCOL_LINE:
+		LineDecoder::decode(data, sink);
+		break;
+	default:
+		if (validateChecksums)
+			RtdDecoder<true>::decode(data, sink);
+		else
+			RtdDecoder<false>::decode(data, sink);
+		break;
 	}
 
 	incrementCounter(COUNTER_PACKETS);
 }
 
-const char *Receiver::processFrame(const std::string_view &frame)
-{
-	enum { NONE, SYNC, HEAD, BODY, CHECKSUM } section = NONE;
-
-	size_t offset = 0;
-	uint8_t calculatedChecksum = 0, receivedChecksum = 0;
-	auto bodyStart = frame.cbegin(), bodyEnd = frame.cend();
-
-	for (auto it = frame.cbegin(); it != frame.cend(); it++) {
-		char c = *it;
-
-		if (section != NONE && section != CHECKSUM)
-			calculatedChecksum += c;
-
-		if (IS_CONTROL_CHAR(c)) {
-			// advance the section in lock-step by control characters
-			// drop the frame if anything unexpected happens
-			switch (c) {
-			case SYN:
-				if (section != NONE)
-					return "unexpected SYN";
-				section = SYNC;
-				break;
-			case SOH:
-				if (section != SYNC)
-					return "unexpected SOH";
-				section = HEAD;
-				break;
-			case STX:
-				if (section != HEAD)
-					return "unexpected STX";
-				section = BODY;
-				bodyStart = it + 1;
-				break;
-			case EOT:
-				// I don't want to clutter the logs with "unexpected EOT"
-				// error messages, since the AS5000 actually does send frames
-				// with no body from time to time, but I don't know why.
-				// Since I don't consider this a packet error, I don't increment
-				// the "dropped frames" counter
-				if (section != BODY)
-					return nullptr;
-				section = CHECKSUM;
-				bodyEnd = it;
-				break;
-			default:
-				return "illegal control character";
-			}
-			// no further processing needed
-			continue;
-		}
-		switch (section) {
-		case NONE:
-			// unexpected; abort processing
-			return "data outside of frame";
-		case SYNC:
-			// this is for synchronization of the electrical current loop, so it doesn't pertain to us
-			break;
-		case HEAD:
-			if (c < '0' || c > '9')
-				return "non-digit in offset field";
+void Receiver::processRelayPacket(const std::string_view &data, size_t input)
+{
+	TRACE_ZONE("processRelayPacket");
 
-			offset *= 10;
-			offset += c - '0';
-			offset %= 100000;
-			break;
-		case BODY:
-			// we just store iterators to the body, so no need to do anything here
-			break;
-		case CHECKSUM:
-			receivedChecksum <<= 4;
+	RelayPacket packet;
+	const char *error = parseRelayPacket(data, packet);
 
-			if (c >= '0' && c <= '9') {
-				receivedChecksum += c - '0';
-			} else if (c >= 'A' && c <= 'F') {
-				receivedChecksum += c - 'A' + 0xA;
-			} else {
-				return "non-hex character in checksum field";
-			}
+	if (error) {
+		blog(LOG_WARNING, "dropping relay packet: %s", error);
+		incrementCounter(COUNTER_ERRORS);
+		metrics->countError(error);
+		return;
+	}
 
-			break;
+	// anything missed is filled in by the next snapshot, so a gap only
+	// needs counting
+	InputStats &stats = inputStats[input];
+	if (stats.relay_sequence && packet.sequence != stats.relay_sequence + 1)
+		stats.relay_gaps++;
+	stats.relay_sequence = packet.sequence;
+
+	uint64_t start = os_gettime_ns();
+	bool clipped = false;
+
+	for (auto &record : packet.records) {
+		// the table upstream can be larger than ours, so records are
+		// cut down to what fits rather than thrown out
+		std::string_view body = record.data;
+		size_t capacity = scoreTable.capacity();
+
+		if (record.offset >= capacity) {
+			clipped = true;
+			continue;
+		}
+		if (body.size() > capacity - record.offset) {
+			body = body.substr(0, capacity - record.offset);
+			clipped = true;
 		}
+
+		applyRange(input, record.offset, body);
 	}
 
-	if (section != CHECKSUM)
-		return "unexpected end of frame";
+	metrics->observeProcessFrame(os_gettime_ns() - start);
 
-	if (calculatedChecksum != receivedChecksum)
-		return "invalid checksum";
+	if (clipped) {
+		stats.rejected++;
+		metrics->countError("relay record out of range");
+	}
 
-	size_t length = bodyEnd - bodyStart;
+	incrementCounter(COUNTER_FRAMES);
+}
 
-	if (offset + length > scoreData.size())
-		scoreData.append(offset + length - scoreData.size(), ' ');
+const char *Receiver::applyRange(size_t input, size_t offset,
+				 const std::string_view &body)
+{
+	// a corrupted header can point anywhere
+	if (!scoreTable.contains(offset, body.size())) {
+		inputStats[input].rejected++;
+		return "frame out of bounds";
+	}
+
+	// already applied from another input
+	if (isDuplicate(input, offset, body))
+		return nullptr;
 
-	scoreData.replace(offset, length, bodyStart, length);
+	profile.record(offset, scoreTable.data() + offset, body);
 
+	// the console repeats itself, and relay snapshots more so
+	if (storeRange(offset, body))
+		derived.markDirty(offset, body.size());
 	return nullptr;
 }
 
+bool Receiver::storeRange(size_t offset, const std::string_view &body)
+{
+	{
+		std::lock_guard<std::mutex> lock(scoreMutex);
+		if (!scoreTable.write(offset, body))
+			return false;
+
+		snapshotDirty = true;
+	}
+
+	relay->markChanged(offset, body.size());
+	shmExport->markChanged(offset, body.size());
+	emit tableChanged(offset, body.size());
+	return true;
+}
+
+void Receiver::updateDerived()
+{
+	TRACE_ZONE("updateDerived");
+
+	// derived fields go out over the relay like the rest of the table
+	derived.evaluate(scoreTable,
+			 [this](size_t offset, const std::string_view &value) {
+				 return storeRange(offset, value);
+			 });
+}
+
+void Receiver::openSnapshot()
+{
+	char *path = obs_module_config_path(SNAPSHOT_FILE);
+	if (!path)
+		return;
+
+	snapshotFile = new QFile(QString::fromUtf8(path), this);
+	bfree(path);
+
+	QDir().mkpath(QFileInfo(*snapshotFile).absolutePath());
+
+	qint64 size = sizeof(SnapshotHeader) + SNAPSHOT_CAPACITY;
+	if (!snapshotFile->open(QIODevice::ReadWrite) ||
+	    !snapshotFile->resize(size) ||
+	    !(snapshot = snapshotFile->map(0, size))) {
+		blog(LOG_WARNING, "failed to open score snapshot %s: %s",
+		     snapshotFile->fileName().toUtf8().constData(),
+		     snapshotFile->errorString().toUtf8().constData());
+		snapshot = nullptr;
+		return;
+	}
+
+	auto header = (SnapshotHeader *)snapshot;
+	int64_t age = QDateTime::currentMSecsSinceEpoch() - header->written_ms;
+
+	if (header->magic == SNAPSHOT_MAGIC &&
+	    header->length <= SNAPSHOT_CAPACITY && age >= 0 &&
+	    age < SNAPSHOT_MAX_AGE_MS) {
+		auto saved = (const char *)snapshot + sizeof(SnapshotHeader);
+
+		std::lock_guard<std::mutex> lock(scoreMutex);
+		scoreTable.resize(std::max<size_t>(scoreTable.capacity(),
+						   header->length));
+		scoreTable.write(0, std::string_view(saved, header->length));
+		blog(LOG_INFO,
+		     "restored %u bytes of score data from %lld s ago",
+		     header->length, (long long)(age / 1000));
+	}
+
+	snapshotTimer = new QTimer(this);
+	connect(snapshotTimer, &QTimer::timeout, this,
+		&Receiver::writeSnapshot);
+	snapshotTimer->start(SNAPSHOT_INTERVAL);
+}
+
+void Receiver::writeSnapshot()
+{
+	if (!snapshot)
+		return;
+
+	auto header = (SnapshotHeader *)snapshot;
+
+	// the table is only written from this thread, so no lock is needed
+	if (snapshotDirty) {
+		uint32_t length = std::min<size_t>(scoreTable.size(),
+						   SNAPSHOT_CAPACITY);
+		memcpy(snapshot + sizeof(SnapshotHeader), scoreTable.data(),
+		       length);
+		header->length = length;
+		header->magic = SNAPSHOT_MAGIC;
+		snapshotDirty = false;
+	}
+
+	// still current as of now, even if nothing has changed
+	header->written_ms = QDateTime::currentMSecsSinceEpoch();
+}
+
+void Receiver::copyRange(uint32_t item_number, uint32_t field_length,
+			 std::string &out) const
+{
+	std::lock_guard<std::mutex> lock(scoreMutex);
+
+	// fields which haven't been received yet read as blank
+	out.assign(field_length, ' ');
+
+	// text sources aren't held to the table like bindings are
+	if (item_number == 0 || item_number > scoreTable.capacity())
+		return;
+
+	size_t available = scoreTable.capacity() - (item_number - 1);
+	size_t length = std::min<size_t>(field_length, available);
+	out.replace(0, length, scoreTable.data() + item_number - 1, length);
+}
+
 static bool dataRangeToBool(const std::string_view &dataRange)
 {
 	for (char c : dataRange) {
@@ -426,91 +1630,446 @@ static bool dataRangeToBool(const std::string_view &dataRange)
 	return false;
 }
 
-void Receiver::updateSources()
+static bool bindingToBool(const Binding &binding,
+			  const std::string_view &dataRange)
+{
+	bool val = dataRangeToBool(dataRange);
+	if (binding.invert_bool)
+		val = !val;
+	return val;
+}
+
+void Receiver::updateSources(uint32_t priority)
 {
-	for (auto &binding : bindings) {
-		// skip over disabled bindings
-		if (!binding.enabled)
+	uint64_t now = os_gettime_ns();
+
+	// edits are picked up at the start of each pass, and any other
+	// priority's unfinished batch is moved over to the new set
+	if (batchCursor[priority] == 0)
+		adoptBindings();
+
+	const auto &list = activeBindings->bindings;
+	for (size_t i = batchCursor[priority]; i < list.size(); i++) {
+		const Binding &binding = *list[i];
+
+		if (binding.priority != priority)
 			continue;
 
-		OBSSourceAutoRelease source =
-			obs_get_source_by_uuid(binding.source_id.c_str());
+		// batched classes give way once they've had their share, so
+		// a long batch never holds up the next packet
+		if (priority != PRIORITY_IMMEDIATE &&
+		    os_gettime_ns() - now > BATCH_BUDGET_NS) {
+			batchCursor[priority] = i;
+			QTimer::singleShot(0, this, [this, priority]() {
+				updateSources(priority);
+			});
+			metrics->observeUpdateSources(os_gettime_ns() - now);
+			return;
+		}
+
+		updateBinding(list[i], bindingStates[i], now);
+	}
 
-		if (!source.Get()) {
-			binding.resetSource();
+	batchCursor[priority] = 0;
+	metrics->observeUpdateSources(os_gettime_ns() - now);
+}
+
+void Receiver::updateBinding(const BindingPtr &ptr, BindingState &state,
+			     uint64_t now)
+{
+	const Binding &binding = *ptr;
+
+	TRACE_ZONE("binding", binding.name.c_str());
+
+	// skip over disabled bindings
+	if (!binding.enabled || state.orphaned) {
+		state.applied.clear();
+		state.pending = false;
+		metrics->countSkippedUpdate();
+		return;
+	}
+
+	// the table covers enabled bindings, see resizeTable, unless one was
+	// published that runs off the end of it
+	if (!scoreTable.contains(binding.item_number - 1,
+				 binding.field_length)) {
+		metrics->countSkippedUpdate();
+		return;
+	}
+
+	std::string_view dataRange =
+		scoreTable.range(binding.item_number - 1, binding.field_length);
+
+	if (binding.filtered())
+		dataRange = filterValue(binding, state, dataRange, now);
+
+	if (binding.target_type == TARGET_PROPERTY) {
+		if (binding.clock_mode) {
+			// resync whenever the controller sends a value
+			state.clock.sync(dataRange, now);
+			state.clock_shown = state.clock.format(now);
+			dataRange = state.clock_shown;
+		}
+
+		// the source already shows this, don't even look it up
+		if (state.applied == dataRange) {
+			metrics->countSkippedUpdate();
+			return;
+		}
+	}
+
+	OBSSourceAutoRelease source = resolveSource(binding);
+
+	// the source is gone, so leave the binding be until it's edited
+	if (!source.Get()) {
+		state.orphaned = true;
+		state.applied.clear();
+		state.pending = false;
+		metrics->countSkippedUpdate();
+		return;
+	}
+
+	if (binding.target_type != TARGET_PROPERTY) {
+		updateSceneItems(binding, source, dataRange);
+		return;
+	}
+
+	// nobody would see the update, so hold it until the source is shown
+	if (!obs_source_showing(source)) {
+		state.pending = true;
+		watchSource(source);
+		metrics->countSkippedUpdate();
+		return;
+	}
+
+	state.pending = false;
+	state.applied = dataRange;
+	updateProperty(ptr, source, dataRange);
+}
+
+std::string_view Receiver::filterValue(const Binding &binding,
+				       BindingState &state,
+				       std::string_view value, uint64_t now)
+{
+	// scene items are only shown or hidden, so values that read the same
+	// way are no change at all
+	auto same = [&](std::string_view a, std::string_view b) {
+		if (binding.target_type == TARGET_PROPERTY)
+			return a == b;
+		return bindingToBool(binding, a) == bindingToBool(binding, b);
+	};
+
+	// the first value goes straight through, there's nothing to flicker
+	// from yet
+	if (!state.settled) {
+		state.settled = true;
+		state.accepted = value;
+		state.changed_ns = now;
+		return state.accepted;
+	}
+
+	if (same(value, state.accepted)) {
+		// went back before the change was let through
+		if (state.holding) {
+			state.holding = false;
+			state.suppressed++;
+			metrics->countSuppressedChange(binding);
+		}
+		return state.accepted;
+	}
+
+	// updates are counted by the frames that have come in since, so
+	// looking again without anything new doesn't count
+	unsigned long long frame = counters[COUNTER_FRAMES];
+	if (!state.holding || !same(value, state.candidate)) {
+		// replaced by yet another value before it was let through
+		if (state.holding) {
+			state.suppressed++;
+			metrics->countSuppressedChange(binding);
+		}
+
+		state.holding = true;
+		state.candidate = value;
+		state.candidate_ns = now;
+		state.candidate_updates = 1;
+		state.candidate_frame = frame;
+	} else if (frame != state.candidate_frame) {
+		state.candidate_updates++;
+		state.candidate_frame = frame;
+	}
+
+	uint64_t due = std::max(
+		state.candidate_ns + binding.hold_ms * 1000000ULL,
+		state.changed_ns + binding.min_interval_ms * 1000000ULL);
+	if (now < due) {
+		holdUntil(due, now);
+		return state.accepted;
+	}
+
+	// more frames will come along to count towards this
+	if (state.candidate_updates < binding.hold_updates)
+		return state.accepted;
+
+	state.holding = false;
+	state.accepted.swap(state.candidate);
+	state.changed_ns = now;
+	return state.accepted;
+}
+
+void Receiver::holdUntil(uint64_t due, uint64_t now)
+{
+	int ms = (int)((due - now + 999999) / 1000000);
+	if (!holdTimer->isActive() || holdTimer->remainingTime() > ms)
+		holdTimer->start(ms);
+}
+
+void Receiver::recheckHeld()
+{
+	uint64_t now = os_gettime_ns();
+
+	const auto &list = activeBindings->bindings;
+	for (size_t i = 0; i < list.size(); i++) {
+		if (bindingStates[i].holding)
+			updateBinding(list[i], bindingStates[i], now);
+	}
+}
+
+void Receiver::watchSource(obs_source_t *source)
+{
+	if (!watchedSources.insert(obs_source_get_uuid(source)).second)
+		return;
+
+	signal_handler_t *sh = obs_source_get_signal_handler(source);
+	signal_handler_connect(sh, "show", &Receiver::sourceShown, this);
+	signal_handler_connect(sh, "activate", &Receiver::sourceShown, this);
+	signal_handler_connect(sh, "destroy", &Receiver::sourceDestroyed, this);
+}
+
+void Receiver::sourceShown(void *data, calldata_t *cd)
+{
+	Receiver *self = (Receiver *)data;
+	obs_source_t *source = (obs_source_t *)calldata_ptr(cd, "source");
+	std::string uuid = obs_source_get_uuid(source);
+
+	// this comes from the video thread; bindings belong to ours
+	QMetaObject::invokeMethod(
+		self, [self, uuid]() { self->applyPending(uuid); },
+		Qt::QueuedConnection);
+}
+
+void Receiver::sourceDestroyed(void *data, calldata_t *cd)
+{
+	Receiver *self = (Receiver *)data;
+	obs_source_t *source = (obs_source_t *)calldata_ptr(cd, "source");
+	std::string uuid = obs_source_get_uuid(source);
+
+	// the signal handler goes with the source, so there's nothing to undo
+	QMetaObject::invokeMethod(
+		self,
+		[self, uuid]() {
+			self->watchedSources.erase(uuid);
+			self->metrics->dropSource(uuid);
+		},
+		Qt::QueuedConnection);
+}
+
+void Receiver::applyPending(const std::string &uuid)
+{
+	TRACE_ZONE("applyPending");
+
+	uint64_t now = os_gettime_ns();
+
+	// all priorities at once, since the source is about to be seen
+	const auto &list = activeBindings->bindings;
+	for (size_t i = 0; i < list.size(); i++) {
+		if (bindingStates[i].pending && list[i]->source_id == uuid)
+			updateBinding(list[i], bindingStates[i], now);
+	}
+}
+
+obs_source_t *Receiver::resolveSource(const Binding &binding)
+{
+	TRACE_ZONE("obs_get_source_by_uuid");
+
+	return obs_get_source_by_uuid(binding.source_id.c_str());
+}
+
+void Receiver::updateClocks()
+{
+	uint64_t now = os_gettime_ns();
+
+	const auto &list = activeBindings->bindings;
+	for (size_t i = 0; i < list.size(); i++) {
+		const Binding &binding = *list[i];
+		BindingState &state = bindingStates[i];
+
+		if (!binding.enabled || !binding.clock_mode ||
+		    binding.target_type != TARGET_PROPERTY || state.orphaned)
+			continue;
+
+		// only touch the source when the displayed text actually moves
+		const std::string &text = state.clock.format(now);
+		if (text == state.clock_shown)
+			continue;
+
+		OBSSourceAutoRelease source = resolveSource(binding);
+		if (!source.Get())
+			continue;
+
+		state.clock_shown = text;
+
+		// catches up from the current time once shown
+		if (!obs_source_showing(source)) {
+			state.pending = true;
+			watchSource(source);
 			continue;
 		}
 
-		auto dataRangeBegin =
-			scoreData.begin() + binding.item_number - 1;
-		auto dataRangeEnd = dataRangeBegin + binding.field_length;
-		std::string_view dataRange(dataRangeBegin.base(),
-					   dataRangeEnd - dataRangeBegin);
-
-		OBSDataAutoRelease settings = obs_source_get_settings(source);
-		obs_properties_t *props = obs_source_properties(source);
-
-		for (auto it = binding.parent_prop.begin();
-		     it != binding.parent_prop.end() - 1; it++) {
-			obs_property_t *prop =
-				obs_properties_get(props, it->c_str());
-			if (obs_property_get_type(prop) == OBS_PROPERTY_GROUP) {
-				props = obs_property_group_content(prop);
-				settings = obs_data_get_obj(
-					settings, obs_property_name(prop));
-			}
+		state.pending = false;
+		state.applied = text;
+		updateProperty(list[i], source, state.clock_shown);
+	}
+}
+
+// sets the binding's property in the source's settings, as described by
+// its properties, without updating the source
+static void setProperty(const Binding &binding, obs_properties_t *props,
+			obs_data_t *settings, std::string_view dataRange)
+{
+	OBSDataAutoRelease group;
+	for (auto it = binding.parent_prop.begin();
+	     it != binding.parent_prop.end() - 1; it++) {
+		obs_property_t *prop = obs_properties_get(props, it->c_str());
+		if (obs_property_get_type(prop) == OBS_PROPERTY_GROUP) {
+			props = obs_property_group_content(prop);
+			group = obs_data_get_obj(settings,
+						 obs_property_name(prop));
+			settings = group;
 		}
+	}
 
-		obs_property_t *prop = obs_properties_get(
-			props, binding.parent_prop.back().c_str());
-
-		obs_property_type type = obs_property_get_type(prop);
-
-		if (type == OBS_PROPERTY_BOOL) {
-			bool val = dataRangeToBool(dataRange);
-			if (binding.invert_bool)
-				val = !val;
-			obs_data_set_bool(settings, obs_property_name(prop),
-					  val);
-		} else if (type == OBS_PROPERTY_TEXT) {
-			if (binding.trim_str) {
-				while (dataRange.front() == ' ') {
-					++dataRangeBegin;
-					dataRange = std::string_view(
-						dataRangeBegin.base(),
-						dataRangeEnd - dataRangeBegin);
-				}
-				while (dataRange.back() == ' ') {
-					--dataRangeEnd;
-					dataRange = std::string_view(
-						dataRangeBegin.base(),
-						dataRangeEnd - dataRangeBegin);
-				}
-			}
-			std::string str(dataRange);
-			obs_data_set_string(settings, obs_property_name(prop),
-					    str.c_str());
-		} else if (type == OBS_PROPERTY_FONT) {
-			bool val = dataRangeToBool(dataRange);
-			if (binding.invert_bool)
-				val = !val;
-
-			OBSDataAutoRelease fontobj = obs_data_get_obj(
-				settings, obs_property_name(prop));
-
-			uint32_t flags = obs_data_get_int(fontobj, "flags");
-
-			if (val)
-				// set the flag
-				flags |= binding.flag_value;
-			else
-				// clear the flag
-				flags &= ~binding.flag_value;
-
-			obs_data_set_int(fontobj, "flags", flags);
+	obs_property_t *prop =
+		obs_properties_get(props, binding.parent_prop.back().c_str());
+
+	obs_property_type type = obs_property_get_type(prop);
+
+	if (type == OBS_PROPERTY_BOOL) {
+		obs_data_set_bool(settings, obs_property_name(prop),
+				  bindingToBool(binding, dataRange));
+	} else if (type == OBS_PROPERTY_TEXT && binding.table.isTable()) {
+		// the whole block in one go, so the source is updated once
+		std::string str;
+		binding.table.render(dataRange, binding.trim_str, str);
+		obs_data_set_string(settings, obs_property_name(prop),
+				    str.c_str());
+	} else if (type == OBS_PROPERTY_TEXT) {
+		if (binding.trim_str) {
+			while (!dataRange.empty() && dataRange.front() == ' ')
+				dataRange.remove_prefix(1);
+			while (!dataRange.empty() && dataRange.back() == ' ')
+				dataRange.remove_suffix(1);
 		}
+		std::string str(dataRange);
+		obs_data_set_string(settings, obs_property_name(prop),
+				    str.c_str());
+	} else if (type == OBS_PROPERTY_FONT) {
+		bool val = bindingToBool(binding, dataRange);
+
+		OBSDataAutoRelease fontobj =
+			obs_data_get_obj(settings, obs_property_name(prop));
+
+		uint32_t flags = obs_data_get_int(fontobj, "flags");
 
-		obs_source_update(source, settings);
-		obs_source_update_properties(source);
+		if (val)
+			// set the flag
+			flags |= binding.flag_value;
+		else
+			// clear the flag
+			flags &= ~binding.flag_value;
+
+		obs_data_set_int(fontobj, "flags", flags);
 	}
 }
+
+static void updateSource(obs_source_t *source, obs_data_t *settings)
+{
+	TRACE_ZONE("obs_source_update", obs_source_get_name(source));
+	obs_source_update(source, settings);
+	obs_source_update_properties(source);
+}
+
+void applyProperties(
+	obs_source_t *source,
+	const std::vector<std::pair<BindingPtr, std::string>> &values)
+{
+	OBSDataAutoRelease settings = obs_source_get_settings(source);
+	obs_properties_t *props = obs_source_properties(source);
+
+	for (auto &value : values)
+		setProperty(*value.first, props, settings, value.second);
+
+	updateSource(source, settings);
+	obs_properties_destroy(props);
+}
+
+void Receiver::updateProperty(const BindingPtr &binding, obs_source_t *source,
+			      std::string_view dataRange)
+{
+	// left to a worker, so a slow source holds up nothing but itself;
+	// clocks go ahead of the rest. Not immediate bindings as such, which
+	// is what every binding starts out as, or the worker kept for urgent
+	// work would be as busy as the others.
+	if (updatePool->isRunning()) {
+		updatePool->queue(source, binding, dataRange,
+				  binding->clock_mode);
+		return;
+	}
+
+	uint64_t start = os_gettime_ns();
+
+	OBSDataAutoRelease settings = obs_source_get_settings(source);
+	obs_properties_t *props = obs_source_properties(source);
+	setProperty(*binding, props, settings, dataRange);
+	updateSource(source, settings);
+	obs_properties_destroy(props);
+
+	metrics->countSourceUpdate(source, os_gettime_ns() - start);
+}
+
+void Receiver::updateSceneItems(const Binding &binding, obs_source_t *source,
+				const std::string_view &dataRange)
+{
+	// scene item targets only flip visibility, so the sources behind them
+	// keep their textures and nothing has to be rendered again
+	obs_scene_t *scene = obs_scene_from_source(source);
+	if (!scene)
+		return;
+
+	TRACE_ZONE("updateSceneItems", obs_source_get_name(source));
+
+	bool val = bindingToBool(binding, dataRange);
+	uint64_t start = os_gettime_ns();
+	bool changed = false;
+
+	obs_sceneitem_t *item =
+		obs_scene_find_sceneitem_by_id(scene, binding.scene_item_id);
+	if (item && obs_sceneitem_visible(item) != val) {
+		obs_sceneitem_set_visible(item, val);
+		changed = true;
+	}
+
+	// the alternate image takes the place of the first one when false
+	if (binding.target_type == TARGET_IMAGE_SWAP) {
+		obs_sceneitem_t *altItem = obs_scene_find_sceneitem_by_id(
+			scene, binding.alt_scene_item_id);
+		if (altItem && obs_sceneitem_visible(altItem) == val) {
+			obs_sceneitem_set_visible(altItem, !val);
+			changed = true;
+		}
+	}
+
+	if (changed)
+		metrics->countSourceUpdate(source, os_gettime_ns() - start);
+	else
+		metrics->countSkippedUpdate();
+}
@@ -3,18 +3,61 @@
 
 #include <obs.h>
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <QFile>
 #include <QString>
 #include <QUdpSocket>
 #include <QHostAddress>
+#include <QTimer>
 
+#include "clock.hpp"
+#include "derived.hpp"
+#include "metrics.hpp"
+#include "score-table.hpp"
+#include "table-layout.hpp"
+#include "update-profile.hpp"
+
+class Relay;
+class Recorder;
+class ShmExport;
+class UpdatePool;
+class LowLatencyInput;
+
+#define TARGET_PROPERTY 0
+#define TARGET_VISIBILITY 1
+#define TARGET_IMAGE_SWAP 2
+
+// immediate bindings are applied as soon as a frame arrives, the others are
+// batched on their own timers
+#define PRIORITY_IMMEDIATE 0
+#define PRIORITY_NORMAL 1
+#define PRIORITY_LOW 2
+
+#define PRIORITY_COUNT 3
+
+// A binding's configuration. Once published in a BindingSet a binding is
+// never changed again: editing one publishes a new set with an edited copy
+// in its place.
 class Binding {
 public:
 	Binding();
 	Binding(obs_data_t *json);
 	obs_data_t *toJSON() const;
-	void resetSource();
+
+	// whether the field lies within the largest possible score table
+	bool inBounds() const;
+
+	// stays the same through edits and renames, for anything that has to
+	// tell bindings apart outside the set, like the metrics
+	std::string id;
 
 	bool enabled;
 	bool trim_str;
@@ -25,14 +68,125 @@ public:
 	uint32_t field_length;
 	std::string source_id;
 	std::vector<std::string> parent_prop;
+
+	// scene item targets: source_id refers to the scene, and the item ids
+	// select which items get shown or hidden
+	uint32_t target_type;
+	int64_t scene_item_id;
+	int64_t alt_scene_item_id;
+
+	// text bindings on a clock field are re-timed locally between updates
+	bool clock_mode;
+
+	// a text binding can show a whole block of the table instead of one
+	// field, in which case field_length covers the block
+	TableLayout table;
+
+	uint32_t priority;
+
+	// a changed field has to keep its new value for hold_ms, and through
+	// hold_updates updates from the feed, before the change is applied,
+	// so values that flicker during a transition never reach the source
+	uint32_t hold_ms;
+	uint32_t hold_updates;
+
+	// changes closer together than this are held back, and the latest
+	// value applied once the time is up
+	uint32_t min_interval_ms;
+
+	inline bool filtered() const
+	{
+		return hold_ms || hold_updates > 1 || min_interval_ms;
+	}
+};
+
+typedef std::shared_ptr<const Binding> BindingPtr;
+
+// An immutable, numbered list of bindings. Bindings that carry over from one
+// version to the next are shared, so whatever the update path keeps for them
+// survives the edit.
+struct BindingSet {
+	uint64_t version;
+	std::vector<BindingPtr> bindings;
+};
+
+typedef std::shared_ptr<const BindingSet> BindingSetPtr;
+
+// what the update path keeps for each binding of the set it's working from
+struct BindingState {
+	ClockInterpolator clock;
+	std::string clock_shown;
+
+	// the value last pushed to the source, so unchanged fields are skipped
+	std::string applied;
+
+	// the field changed while its source wasn't showing, so it gets applied
+	// once the source is shown
+	bool pending;
+
+	// the source is gone, so the binding is left alone until it's edited
+	bool orphaned;
+
+	// for filtered bindings, the value last let through, and one that's
+	// waiting to be: since when, and through how many updates
+	bool settled;
+	std::string accepted;
+	bool holding;
+	std::string candidate;
+	uint64_t candidate_ns;
+	uint32_t candidate_updates;
+	unsigned long long candidate_frame;
+	uint64_t changed_ns;
+
+	// changes that never got through
+	unsigned long long suppressed;
 };
 
+// sets each binding's property to its value on the source and updates the
+// source once; safe from any thread
+void applyProperties(
+	obs_source_t *source,
+	const std::vector<std::pair<BindingPtr, std::string>> &values);
+
 #define COUNTER_PACKETS 0
 #define COUNTER_FRAMES 1
 #define COUNTER_ERRORS 2
 
 #define COUNTERS_COUNT 3
 
+// what each input speaks, see decoders.hpp
+#define PROTOCOL_RTD 0
+#define PROTOCOL_LINE 1
+
+#define PROTOCOL_COUNT 2
+
+struct InputAddress {
+	QHostAddress addr;
+	quint16 port;
+	uint32_t protocol;
+};
+
+struct InputStats {
+	unsigned long long frames;
+	// frames this input was the first to deliver, and ones it was beaten to
+	unsigned long long first;
+	unsigned long long duplicates;
+	// smoothed delay behind whichever input delivered each frame first
+	double latency_ms;
+	uint64_t last_ns;
+	// for inputs fed by another instance's relay
+	uint32_t relay_sequence;
+	unsigned long long relay_gaps;
+	// frames that fell outside the score table
+	unsigned long long rejected;
+};
+
+// "address:port" pairs separated by commas, as shown in the settings. An
+// input that isn't RTD has its protocol after the port, as in
+// "address:port@line".
+bool parseInputList(const QString &str, std::vector<InputAddress> &out);
+QString formatInputList(const std::vector<InputAddress> &inputs);
+
 class Receiver : public QObject {
 	Q_OBJECT
 
@@ -40,18 +194,126 @@ public:
 	Receiver();
 	~Receiver();
 
-	inline bool isEnabled() { return socket != nullptr; }
+	// stops receiving and applying, and lets go of the sources, while
+	// OBS is still up; from the frontend's EXIT. The table stays readable
+	// until the receiver is deleted on unload.
+	void shutdown();
+
+	inline bool isEnabled() { return inputCount() > 0; }
+
+	// reads the config and brings the receiver up, once OBS has finished
+	// loading; the bindings arrive a little later from a loader thread
+	void start();
 
 	void updateReceiver(bool enabled);
 
+	// the current binding set, safe to call from any thread
+	BindingSetPtr getBindings() const;
+
+	// replaces the binding set, from the UI thread. The update path
+	// switches over at the start of its next pass, and saving is up to
+	// the caller.
+	BindingSetPtr publishBindings(std::vector<BindingPtr> list);
+
+	// publishes the set with one binding in place of another, or added if
+	// the old one has gone in the meantime
+	void replaceBinding(const BindingPtr &old, const BindingPtr &binding);
+
+	// binding is a copy of old that only differs in what doesn't affect
+	// updating it, such as its name, so it keeps old's applied value and
+	// clock; from the UI thread, before the set with it is published
+	void carryState(const BindingPtr &old, const BindingPtr &binding);
+
+	// each scene collection has bindings of its own; this switches to the
+	// current one's, from the frontend's SCENE_COLLECTION_CHANGED
+	void sceneCollectionChanged();
+
+	// the current collection's bindings file follows it to its new
+	// name, from the frontend's SCENE_COLLECTION_RENAMED
+	void sceneCollectionRenamed();
+
+	// copies a field out of the score table, safe to call from any thread
+	void copyRange(uint32_t item_number, uint32_t field_length,
+		       std::string &out) const;
+
 	QHostAddress udsAddr;
 	quint16 udsPort;
 	QHostAddress listenAddr;
 	quint16 listenPort;
+	uint32_t listenProtocol;
 
 	bool validateChecksums;
 
-	std::vector<Binding> bindings;
+	// the score table holds this much, or as far as the bindings or
+	// derived fields reach if that's further
+	uint32_t tableSize;
+
+	// definitions of fields computed from others, see DerivedFields
+	QString derivedFields;
+
+	// Prometheus export, see Metrics::configure
+	quint16 metricsPort;
+	QString metricsFile;
+	Metrics *metrics;
+
+	// how often each batched priority class is applied, in milliseconds
+	uint32_t priorityIntervals[PRIORITY_COUNT];
+
+	// extra listeners carrying the same feed, e.g. a backup path from the
+	// console. Frames are applied from whichever input delivers them first.
+	std::vector<InputAddress> backupInputs;
+
+	// downstream instances (or a multicast group) that get our score
+	// table, see Relay
+	std::vector<InputAddress> relayPeers;
+	Relay *relay;
+
+	// write a sidecar of the score table next to each recording, see
+	// Recorder
+	bool recordSidecar;
+	Recorder *recorder;
+
+	// POSIX shared memory segment the table is mirrored to for other
+	// programs on this machine, empty for none; see ShmExport
+	QString shmName;
+	ShmExport *shmExport;
+
+	// property updates are applied on this many threads of their own, or
+	// on the receiver's if 0; see UpdatePool
+	uint32_t updateWorkers;
+	UpdatePool *updatePool;
+
+	// read inputs on dedicated threads with kernel timestamps, see
+	// LowLatencyInput
+	bool lowLatency;
+	uint32_t busyPollUs;
+	int cpuAffinity;
+	bool realtimeThread;
+
+	// hands a datagram from a low-latency input to the receiver's thread;
+	// safe to call from any thread
+	void queueDatagram(size_t input, std::string &&data,
+			   uint64_t arrival_ns);
+
+	inline const std::vector<InputStats> &getInputStats() const
+	{
+		return inputStats;
+	}
+	QString inputName(size_t input) const;
+
+	inline unsigned long long getCounter(int which) const
+	{
+		return counters[which];
+	}
+
+	// only from the receiver's thread; use copyRange anywhere else
+	inline const ScoreTable &getScoreTable() const { return scoreTable; }
+
+	// how often the feed has written and changed each binding and region
+	// of the table, and how many changes bindings have held back, since
+	// the profile was reset; from the receiver's thread
+	ProfileReport profileReport() const;
+	void resetProfile();
 
 public slots:
 	void socketReady();
@@ -60,11 +322,69 @@ public slots:
 
 	void saveConfig() const;
 
+	void updateClocks();
+
+	void writeSnapshot();
+
 signals:
 	void counterChanged(int which, unsigned long long newval);
 
+	// a range of the score table took a new value
+	void tableChanged(size_t offset, size_t length);
+
+	// another scene collection's bindings have been published
+	void bindingsSwitched();
+
 private:
-	QUdpSocket *socket;
+	// drives the pipeline directly, see bench/
+	friend class ReceiverBenchmark;
+
+	// the primary listener comes first, followed by the backups. Only one
+	// of these is used, depending on lowLatency.
+	std::vector<QUdpSocket *> sockets;
+	std::vector<LowLatencyInput *> lowLatencyInputs;
+	std::vector<uint32_t> inputProtocols;
+	inline size_t inputCount() const
+	{
+		return sockets.size() + lowLatencyInputs.size();
+	}
+	bool bindInput(const InputAddress &address);
+	void closeInputs();
+
+	struct QueuedDatagram {
+		size_t input;
+		std::string data;
+		uint64_t arrival_ns;
+	};
+	std::mutex queueMutex;
+	std::vector<QueuedDatagram> datagramQueue;
+	std::vector<QueuedDatagram> drainBuffer;
+	void drainQueue();
+
+	// kernel arrival time of the datagram being processed, when known
+	uint64_t arrivalNs;
+	std::vector<InputStats> inputStats;
+	QTimer *clockTimer;
+	QTimer *priorityTimers[PRIORITY_COUNT];
+
+	// where an unfinished batch picks up again
+	size_t batchCursor[PRIORITY_COUNT];
+
+	// recently applied frames, keyed by offset and content
+	struct RecentFrame {
+		uint64_t first_ns;
+		uint64_t last_ns;
+		std::vector<uint32_t> deliveries;
+	};
+	std::unordered_map<uint64_t, RecentFrame> recentFrames;
+	uint64_t lastPrune;
+
+	// the frame last applied at each offset
+	std::unordered_map<size_t, uint64_t> latestFrames;
+
+	bool isDuplicate(size_t input, size_t offset,
+			 const std::string_view &body);
+	void pruneRecentFrames(uint64_t now);
 
 	// counter mechanics
 	unsigned long long counters[COUNTERS_COUNT];
@@ -74,11 +394,105 @@ private:
 		emit counterChanged(which, counters[which]);
 	}
 
-	std::string scoreData;
+	// only written from the receiver thread, which may read it freely
+	ScoreTable scoreTable;
+	mutable std::mutex scoreMutex;
+	void resizeTable();
+
+	// counts what the feed writes to the table, see UpdateProfile
+	UpdateProfile profile;
+
+	// writes a range that's been checked against the table and passes the
+	// change on; false if it didn't change anything
+	bool storeRange(size_t offset, const std::string_view &body);
+
+	// evaluated once the packets that came in together have been applied
+	DerivedFields derived;
+	void updateDerived();
+
+	// only through std::atomic_load and std::atomic_store
+	BindingSetPtr bindings;
+
+	// the set the update path is working from, and its state for each of
+	// those bindings, in the same order
+	BindingSetPtr activeBindings;
+	std::vector<BindingState> bindingStates;
+	void adoptBindings();
+
+	// copies that are to take over another binding's state once they're
+	// adopted, see carryState
+	std::unordered_map<const Binding *, BindingPtr> carriedStates;
+
+	// config saves are held off until the bindings have been loaded
+	bool loaded;
+	std::thread loader;
+	void loadBindings(std::function<void()> done);
+	void bindingsLoaded(uint64_t generation,
+			    std::vector<BindingPtr> &loadedBindings,
+			    bool migrated, const std::function<void()> &done);
+
+	// the shared list from before collections had their own has been
+	// handed to one this session
+	bool sharedMigrated;
+
+	// the scene collection whose bindings are published, empty without a
+	// frontend or before start()
+	std::string collection;
+	uint64_t collectionSwitches;
+
+	// binding lists of the collections used recently, most recent first,
+	// so switching back to one doesn't wait for it to be loaded again
+	struct CachedBindings {
+		std::string collection;
+		std::vector<BindingPtr> bindings;
+	};
+	std::vector<CachedBindings> bindingCache;
+	void cacheBindings(const std::string &name,
+			   const std::vector<BindingPtr> &list);
+	void switchedBindings();
+
+	// memory-mapped copy of scoreTable, restored on start
+	QFile *snapshotFile;
+	uchar *snapshot;
+	bool snapshotDirty;
+	QTimer *snapshotTimer;
+	void openSnapshot();
+
+	// feeds the decoders into applyRange
+	struct DecoderSink;
+
+	void processDatagram(const std::string_view &data, size_t input);
+	void processRelayPacket(const std::string_view &data, size_t input);
+	const char *applyRange(size_t input, size_t offset,
+			       const std::string_view &body);
+	void updateSources(uint32_t priority);
+
+	// what a filtered binding lets through of its field's value
+	std::string_view filterValue(const Binding &binding,
+				     BindingState &state,
+				     std::string_view value, uint64_t now);
+
+	// goes back to bindings holding a value once they've held it long
+	// enough, in case nothing else comes along
+	QTimer *holdTimer;
+	void holdUntil(uint64_t due, uint64_t now);
+	void recheckHeld();
+
+	void updateBinding(const BindingPtr &binding, BindingState &state,
+			   uint64_t now);
+	obs_source_t *resolveSource(const Binding &binding);
+	void updateProperty(const BindingPtr &binding, obs_source_t *source,
+			    std::string_view dataRange);
+	void updateSceneItems(const Binding &binding, obs_source_t *source,
+			      const std::string_view &dataRange);
 
-	void processDatagram(const std::string_view &data);
-	const char *processFrame(const std::string_view &frame);
-	void updateSources();
+	// sources with pending bindings, by uuid, which we've hooked show and
+	// activate on
+	std::unordered_set<std::string> watchedSources;
+	void watchSource(obs_source_t *source);
+	void applyPending(const std::string &uuid);
+	static void sourceShown(void *data, calldata_t *cd);
+	static void sourceDestroyed(void *data, calldata_t *cd);
 };
 
 #endif // OBSSB_RECEIVER_HPP
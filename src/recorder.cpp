@@ -0,0 +1,148 @@
+#include <obs-frontend-api.h>
+#include <obs.hpp>
+#include <util/platform.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include "recorder.hpp"
+#include "receiver.hpp"
+
+#include "plugin-macros.generated.h"
+
+#define SIDECAR_EXTENSION ".scoreboard"
+
+// how often what's been encoded goes out to disk, in milliseconds, so a
+// crash loses next to nothing
+#define SIDECAR_FLUSH_INTERVAL 1000
+
+Recorder::Recorder(Receiver *receiver_) : QObject(receiver_)
+{
+	receiver = receiver_;
+	file = nullptr;
+	startNs = 0;
+	pausedNs = 0;
+	pauseStartNs = 0;
+
+	flushTimer = new QTimer(this);
+	connect(flushTimer, &QTimer::timeout, this, &Recorder::flush);
+}
+
+// the sidecar goes next to the recording, under the same name
+static QString sidecarPath()
+{
+	OBSOutputAutoRelease output = obs_frontend_get_recording_output();
+	if (!output)
+		return QString();
+
+	OBSDataAutoRelease settings = obs_output_get_settings(output);
+	QString path = obs_data_get_string(settings, "path");
+	if (path.isEmpty())
+		return QString();
+
+	QFileInfo info(path);
+	return info.dir().filePath(info.completeBaseName() + SIDECAR_EXTENSION);
+}
+
+void Recorder::recordingStarted()
+{
+	if (!receiver->recordSidecar || file)
+		return;
+
+	QString path = sidecarPath();
+	if (path.isEmpty()) {
+		blog(LOG_WARNING, "no recording path for the score sidecar");
+		return;
+	}
+
+	file = new QFile(path, this);
+	if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		blog(LOG_WARNING, "failed to open score sidecar %s: %s",
+		     path.toUtf8().constData(),
+		     file->errorString().toUtf8().constData());
+		delete file;
+		file = nullptr;
+		return;
+	}
+
+	startNs = os_gettime_ns();
+	pausedNs = 0;
+	pauseStartNs = 0;
+
+	const ScoreTable &table = receiver->getScoreTable();
+	encoder.begin(QDateTime::currentMSecsSinceEpoch(),
+		      table.range(0, table.size()));
+
+	connect(receiver, &Receiver::tableChanged, this,
+		&Recorder::tableChanged);
+	flushTimer->start(SIDECAR_FLUSH_INTERVAL);
+
+	blog(LOG_INFO, "recording score sidecar to %s",
+	     path.toUtf8().constData());
+}
+
+void Recorder::recordingStopped()
+{
+	if (!file)
+		return;
+
+	disconnect(receiver, &Receiver::tableChanged, this,
+		   &Recorder::tableChanged);
+	flushTimer->stop();
+
+	// the index only goes on once nothing more can be added
+	encoder.end();
+	flush();
+
+	blog(LOG_INFO, "finished score sidecar %s",
+	     file->fileName().toUtf8().constData());
+
+	file->close();
+	delete file;
+	file = nullptr;
+}
+
+void Recorder::recordingPaused()
+{
+	if (file && !pauseStartNs)
+		pauseStartNs = os_gettime_ns();
+}
+
+void Recorder::recordingUnpaused()
+{
+	if (!pauseStartNs)
+		return;
+
+	pausedNs += os_gettime_ns() - pauseStartNs;
+	pauseStartNs = 0;
+}
+
+uint64_t Recorder::timeline() const
+{
+	// changes while paused land at the cut, so the state is right when
+	// the recording carries on
+	uint64_t now = pauseStartNs ? pauseStartNs : os_gettime_ns();
+	return (now - startNs - pausedNs) / 1000;
+}
+
+void Recorder::tableChanged(size_t offset, size_t length)
+{
+	const ScoreTable &table = receiver->getScoreTable();
+	if (!table.contains(offset, length))
+		return;
+
+	encoder.update(timeline(), offset, table.range(offset, length));
+}
+
+void Recorder::flush()
+{
+	encoder.take(buffer);
+	if (buffer.empty())
+		return;
+
+	if (file->write(buffer.data(), buffer.size()) != (qint64)buffer.size())
+		blog(LOG_WARNING, "failed to write score sidecar: %s",
+		     file->errorString().toUtf8().constData());
+	file->flush();
+}
@@ -0,0 +1,52 @@
+#ifndef OBSSB_RECORDER_HPP
+#define OBSSB_RECORDER_HPP
+
+#include <cstdint>
+#include <string>
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+
+#include "sidecar.hpp"
+
+class Receiver;
+
+// Writes the score table's changes to a sidecar file next to each OBS
+// recording, see sidecar.hpp. Its timeline is the recording's: it starts when
+// the recording does and stands still while it's paused.
+class Recorder : public QObject {
+	Q_OBJECT
+
+public:
+	explicit Recorder(Receiver *receiver);
+
+	// from the frontend's recording events
+	void recordingStarted();
+	void recordingStopped();
+	void recordingPaused();
+	void recordingUnpaused();
+
+	inline bool isRecording() const { return file != nullptr; }
+
+private slots:
+	void tableChanged(size_t offset, size_t length);
+	void flush();
+
+private:
+	Receiver *receiver;
+	SidecarEncoder encoder;
+	QFile *file;
+	QTimer *flushTimer;
+	std::string buffer;
+
+	uint64_t startNs;
+
+	// all the time spent paused, and when the current pause began
+	uint64_t pausedNs;
+	uint64_t pauseStartNs;
+
+	uint64_t timeline() const;
+};
+
+#endif // OBSSB_RECORDER_HPP
@@ -0,0 +1,200 @@
+#include <obs.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "relay.hpp"
+#include "receiver.hpp"
+
+#include "plugin-macros.generated.h"
+
+#define RELAY_MAGIC "OSBR"
+#define RELAY_MAGIC_LEN 4
+#define RELAY_VERSION 1
+#define RELAY_HEADER_LEN (RELAY_MAGIC_LEN + 1 + 1 + 4)
+#define RELAY_RECORD_HEADER_LEN (4 + 2)
+
+// small enough to never be fragmented on an ordinary network
+#define RELAY_MAX_DATAGRAM 1200
+
+// ranges closer than this are sent as one, which is smaller than two headers
+#define RELAY_MERGE_GAP RELAY_RECORD_HEADER_LEN
+
+#define RELAY_SNAPSHOT_INTERVAL 1000
+
+bool isRelayPacket(const std::string_view &data)
+{
+	return data.size() >= RELAY_MAGIC_LEN &&
+	       memcmp(data.data(), RELAY_MAGIC, RELAY_MAGIC_LEN) == 0;
+}
+
+static uint32_t readU32(const char *p)
+{
+	auto u = (const uint8_t *)p;
+	return u[0] | (u[1] << 8) | (u[2] << 16) | ((uint32_t)u[3] << 24);
+}
+
+static uint16_t readU16(const char *p)
+{
+	auto u = (const uint8_t *)p;
+	return u[0] | (u[1] << 8);
+}
+
+static void appendU32(QByteArray &out, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		out.append((char)(value >> (i * 8)));
+}
+
+static void appendU16(QByteArray &out, uint16_t value)
+{
+	out.append((char)value);
+	out.append((char)(value >> 8));
+}
+
+const char *parseRelayPacket(const std::string_view &data, RelayPacket &out)
+{
+	if (!isRelayPacket(data) || data.size() < RELAY_HEADER_LEN)
+		return "short relay header";
+	if ((uint8_t)data[RELAY_MAGIC_LEN] != RELAY_VERSION)
+		return "unsupported relay version";
+
+	out.type = data[RELAY_MAGIC_LEN + 1];
+	out.sequence = readU32(data.data() + RELAY_MAGIC_LEN + 2);
+	out.records.clear();
+
+	if (out.type != RELAY_DELTA && out.type != RELAY_SNAPSHOT)
+		return "unknown relay packet type";
+
+	size_t pos = RELAY_HEADER_LEN;
+	while (pos < data.size()) {
+		if (data.size() - pos < RELAY_RECORD_HEADER_LEN)
+			return "truncated relay record";
+
+		uint32_t offset = readU32(data.data() + pos);
+		uint16_t length = readU16(data.data() + pos + 4);
+		pos += RELAY_RECORD_HEADER_LEN;
+
+		if (data.size() - pos < length)
+			return "truncated relay record";
+
+		out.records.push_back({offset, data.substr(pos, length)});
+		pos += length;
+	}
+
+	return nullptr;
+}
+
+Relay::Relay(Receiver *receiver_) : QObject(receiver_)
+{
+	receiver = receiver_;
+	sequence = 0;
+
+	socket = new QUdpSocket(this);
+
+	snapshotTimer = new QTimer(this);
+	connect(snapshotTimer, &QTimer::timeout, this, &Relay::sendSnapshot);
+}
+
+void Relay::configure(const std::vector<InputAddress> &peers_)
+{
+	peers = peers_;
+	changed.clear();
+
+	if (peers.empty()) {
+		snapshotTimer->stop();
+		return;
+	}
+
+	// give everyone downstream the whole table straight away
+	snapshotTimer->start(RELAY_SNAPSHOT_INTERVAL);
+	sendSnapshot();
+}
+
+void Relay::markChanged(size_t offset, size_t length)
+{
+	if (!peers.empty() && length)
+		changed.emplace_back(offset, offset + length);
+}
+
+void Relay::flush()
+{
+	if (changed.empty())
+		return;
+
+	std::sort(changed.begin(), changed.end());
+
+	std::vector<std::pair<size_t, size_t>> merged;
+	for (auto &range : changed) {
+		if (!merged.empty() &&
+		    range.first <= merged.back().second + RELAY_MERGE_GAP)
+			merged.back().second =
+				std::max(merged.back().second, range.second);
+		else
+			merged.push_back(range);
+	}
+	changed.clear();
+
+	send(RELAY_DELTA, merged);
+}
+
+void Relay::sendSnapshot()
+{
+	const ScoreTable &table = receiver->getScoreTable();
+	if (table.empty())
+		return;
+
+	send(RELAY_SNAPSHOT, {{0, table.size()}});
+}
+
+void Relay::send(uint8_t type,
+		 const std::vector<std::pair<size_t, size_t>> &ranges)
+{
+	const ScoreTable &table = receiver->getScoreTable();
+
+	QByteArray packet;
+
+	for (auto &range : ranges) {
+		size_t pos = range.first;
+		size_t end = std::min(range.second, table.size());
+
+		// long ranges are split across as many packets as they need
+		while (pos < end) {
+			if (packet.size() + RELAY_RECORD_HEADER_LEN >=
+			    RELAY_MAX_DATAGRAM) {
+				sendPacket(packet);
+				packet.clear();
+			}
+
+			if (packet.isEmpty()) {
+				packet.append(RELAY_MAGIC, RELAY_MAGIC_LEN);
+				packet.append((char)RELAY_VERSION);
+				packet.append((char)type);
+				appendU32(packet, ++sequence);
+			}
+
+			size_t room = RELAY_MAX_DATAGRAM - packet.size() -
+				      RELAY_RECORD_HEADER_LEN;
+			size_t length = std::min(end - pos, room);
+
+			appendU32(packet, (uint32_t)pos);
+			appendU16(packet, (uint16_t)length);
+			packet.append(table.data() + pos, (qsizetype)length);
+			pos += length;
+		}
+	}
+
+	if (!packet.isEmpty())
+		sendPacket(packet);
+}
+
+void Relay::sendPacket(const QByteArray &packet)
+{
+	for (auto &peer : peers) {
+		if (socket->writeDatagram(packet, peer.addr, peer.port) < 0)
+			blog(LOG_DEBUG, "failed to relay to %s:%d: %s",
+			     peer.addr.toString().toUtf8().constData(),
+			     peer.port,
+			     socket->errorString().toUtf8().constData());
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef OBSSB_RELAY_HPP
+#define OBSSB_RELAY_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include "receiver.hpp"
+
+// Relay packets carry changed ranges of the score table between instances:
+//
+//   "OSBR" | version (1) | type (1) | sequence (4) | records...
+//   record: offset (4) | length (2) | data
+//
+// integers are little-endian. Sequence numbers count packets, so a receiver
+// can tell when it missed some; the periodic snapshots fill in whatever was
+// lost.
+
+#define RELAY_DELTA 1
+#define RELAY_SNAPSHOT 2
+
+struct RelayRecord {
+	uint32_t offset;
+	std::string_view data;
+};
+
+struct RelayPacket {
+	uint8_t type;
+	uint32_t sequence;
+	std::vector<RelayRecord> records;
+};
+
+bool isRelayPacket(const std::string_view &data);
+
+// returns an error, or nullptr with the packet filled in. The records point
+// into data.
+const char *parseRelayPacket(const std::string_view &data, RelayPacket &out);
+
+// Forwards the receiver's score table to downstream instances: changed
+// ranges are sent after every batch of packets, and the whole table every
+// so often for anyone who joined late or lost a packet. Peers can be unicast
+// addresses or a multicast group.
+class Relay : public QObject {
+	Q_OBJECT
+
+public:
+	explicit Relay(Receiver *receiver);
+
+	// an empty list turns relaying off
+	void configure(const std::vector<InputAddress> &peers);
+
+	inline bool isEnabled() const { return !peers.empty(); }
+
+	void markChanged(size_t offset, size_t length);
+
+	// sends everything marked since the last flush
+	void flush();
+
+private slots:
+	void sendSnapshot();
+
+private:
+	Receiver *receiver;
+	QUdpSocket *socket;
+	QTimer *snapshotTimer;
+	std::vector<InputAddress> peers;
+	uint32_t sequence;
+
+	// [begin, end) ranges, merged on flush
+	std::vector<std::pair<size_t, size_t>> changed;
+
+	void send(uint8_t type,
+		  const std::vector<std::pair<size_t, size_t>> &ranges);
+	void sendPacket(const QByteArray &packet);
+};
+
+#endif // OBSSB_RELAY_HPP
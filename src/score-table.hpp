@@ -0,0 +1,66 @@
+#ifndef OBSSB_SCORE_TABLE_HPP
+#define OBSSB_SCORE_TABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// no console addresses more than this, and it's what the snapshot holds
+#define SCORE_TABLE_MAX_CAPACITY 131072
+
+#define SCORE_TABLE_DEFAULT_CAPACITY 16384
+
+// The score table as the console sends it. Its capacity is only changed when
+// the configuration is, so frames are written in place without ever
+// allocating, and anything that doesn't fit is turned away. Bytes that
+// haven't been received read as spaces.
+class ScoreTable {
+public:
+	inline ScoreTable() : used(0) {}
+
+	// keeps whatever still fits
+	inline void resize(size_t capacity)
+	{
+		capacity = std::min<size_t>(capacity, SCORE_TABLE_MAX_CAPACITY);
+		table.resize(capacity, ' ');
+		used = std::min(used, capacity);
+	}
+
+	inline size_t capacity() const { return table.size(); }
+
+	// up to the last byte received, which is what's worth passing on
+	inline size_t size() const { return used; }
+	inline bool empty() const { return used == 0; }
+	inline const char *data() const { return table.data(); }
+
+	inline bool contains(size_t offset, size_t length) const
+	{
+		return offset <= table.size() &&
+		       length <= table.size() - offset;
+	}
+
+	// only for ranges that are contained
+	inline std::string_view range(size_t offset, size_t length) const
+	{
+		return std::string_view(table.data() + offset, length);
+	}
+
+	// returns false if the range already held this, or doesn't fit
+	inline bool write(size_t offset, const std::string_view &data)
+	{
+		if (!contains(offset, data.size()) ||
+		    table.compare(offset, data.size(), data) == 0)
+			return false;
+
+		table.replace(offset, data.size(), data);
+		used = std::max(used, offset + data.size());
+		return true;
+	}
+
+private:
+	std::string table;
+	size_t used;
+};
+
+#endif // OBSSB_SCORE_TABLE_HPP
@@ -0,0 +1,415 @@
+#include <obs-module.h>
+#include <obs.hpp>
+#include <graphics/graphics.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QPainter>
+
+#include "scoreboard-text.hpp"
+#include "clock.hpp"
+#include "receiver.hpp"
+#include "table-layout.hpp"
+
+#include "plugin-macros.generated.h"
+
+#define SETTING_ITEMNO "item_number"
+#define SETTING_LENGTH "field_length"
+#define SETTING_FONT "font"
+#define SETTING_COLOR "color"
+#define SETTING_TRIM_STR "trim_str"
+#define SETTING_FIXED_PITCH "fixed_pitch"
+#define SETTING_CLOCK_MODE "clock_mode"
+#define SETTING_TABLE_ROWS "table_rows"
+#define SETTING_TABLE_STRIDE "table_stride"
+#define SETTING_TABLE_COLUMNS "table_columns"
+
+#define ATLAS_COLUMNS 16
+#define ATLAS_PADDING 2
+
+extern Receiver *receiver;
+
+GlyphAtlas::GlyphAtlas(obs_data_t *fontobj, uint32_t color) : tex(nullptr)
+{
+	QFont font(obs_data_get_string(fontobj, "face"));
+	const char *style = obs_data_get_string(fontobj, "style");
+	if (*style)
+		font.setStyleName(style);
+	int size = (int)obs_data_get_int(fontobj, "size");
+	font.setPixelSize(size > 0 ? size : 72);
+
+	uint32_t flags = obs_data_get_int(fontobj, "flags");
+	font.setBold(flags & OBS_FONT_BOLD);
+	font.setItalic(flags & OBS_FONT_ITALIC);
+	font.setUnderline(flags & OBS_FONT_UNDERLINE);
+	font.setStrikeOut(flags & OBS_FONT_STRIKEOUT);
+
+	QFontMetrics metrics(font);
+
+	// every glyph gets a cell wide enough for the widest one, so italic
+	// overhangs don't bleed into their neighbours
+	uint32_t cellWidth = 0;
+	pitch = 0;
+	for (char c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+		QChar qc(c);
+		uint32_t advance = metrics.horizontalAdvance(qc);
+		uint32_t width = metrics.boundingRect(qc).right() + 1;
+		pitch = std::max(pitch, advance);
+		cellWidth = std::max(cellWidth, std::max(advance, width));
+	}
+	cellWidth += ATLAS_PADDING;
+	height = metrics.height();
+
+	uint32_t rows = (GLYPH_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+	image = QImage(cellWidth * ATLAS_COLUMNS,
+		       (height + ATLAS_PADDING) * rows,
+		       QImage::Format_RGBA8888_Premultiplied);
+	image.fill(Qt::transparent);
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::TextAntialiasing);
+	painter.setFont(font);
+	painter.setPen(QColor(color & 0xFF, (color >> 8) & 0xFF,
+			      (color >> 16) & 0xFF, (color >> 24) & 0xFF));
+
+	for (int i = 0; i < GLYPH_COUNT; i++) {
+		Glyph &glyph = glyphs[i];
+		QChar qc(GLYPH_FIRST + i);
+
+		glyph.x = (i % ATLAS_COLUMNS) * cellWidth;
+		glyph.y = (i / ATLAS_COLUMNS) * (height + ATLAS_PADDING);
+		glyph.cx = cellWidth - ATLAS_PADDING;
+		glyph.advance = metrics.horizontalAdvance(qc);
+
+		painter.drawText(glyph.x, glyph.y + metrics.ascent(),
+				 QString(qc));
+	}
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	if (!tex)
+		return;
+
+	obs_enter_graphics();
+	gs_texture_destroy(tex);
+	obs_leave_graphics();
+}
+
+std::shared_ptr<GlyphAtlas> GlyphAtlas::get(obs_data_t *font, uint32_t color)
+{
+	static std::mutex cacheMutex;
+	static std::map<std::string, std::weak_ptr<GlyphAtlas>> cache;
+
+	std::string key = obs_data_get_json(font);
+	key += '#';
+	key += std::to_string(color);
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	auto atlas = cache[key].lock();
+	if (!atlas) {
+		// fonts nobody uses any more go, rather than every one ever
+		// picked staying around
+		for (auto it = cache.begin(); it != cache.end();) {
+			if (it->second.expired())
+				it = cache.erase(it);
+			else
+				++it;
+		}
+
+		atlas = std::make_shared<GlyphAtlas>(font, color);
+		cache[key] = atlas;
+	}
+
+	return atlas;
+}
+
+gs_texture_t *GlyphAtlas::texture()
+{
+	if (!tex) {
+		const uint8_t *data = image.constBits();
+		tex = gs_texture_create(image.width(), image.height(), GS_RGBA,
+					1, &data, 0);
+	}
+	return tex;
+}
+
+struct scoreboard_text {
+	obs_source_t *source;
+
+	// settings, written by update and read from the graphics thread
+	std::mutex mutex;
+	std::shared_ptr<GlyphAtlas> atlas;
+	uint32_t item_number;
+	uint32_t field_length;
+	bool trim_str;
+	bool fixed_pitch;
+	bool clock_mode;
+	TableLayout table;
+
+	// only touched from the graphics thread
+	ClockInterpolator clock;
+	std::string value;
+	// the table's block as last laid out, and as it is now
+	std::string shown;
+	std::string block;
+	std::string_view text;
+	uint32_t width;
+	uint32_t height;
+};
+
+static const char *scoreboard_text_get_name(void *type_data)
+{
+	UNUSED_PARAMETER(type_data);
+	return T("OBSScoreboard.TextSource");
+}
+
+static void scoreboard_text_update(void *data, obs_data_t *settings)
+{
+	auto s = (scoreboard_text *)data;
+
+	OBSDataAutoRelease font = obs_data_get_obj(settings, SETTING_FONT);
+	uint32_t color = obs_data_get_int(settings, SETTING_COLOR);
+
+	// rasterizing happens here, once, and never on the per-frame path
+	auto atlas = GlyphAtlas::get(font, color);
+
+	std::lock_guard<std::mutex> lock(s->mutex);
+	s->atlas = atlas;
+	s->item_number = obs_data_get_int(settings, SETTING_ITEMNO);
+	s->field_length = obs_data_get_int(settings, SETTING_LENGTH);
+	s->trim_str = obs_data_get_bool(settings, SETTING_TRIM_STR);
+	s->fixed_pitch = obs_data_get_bool(settings, SETTING_FIXED_PITCH);
+	s->clock_mode = obs_data_get_bool(settings, SETTING_CLOCK_MODE);
+
+	// rows of a block in place of the field, one line each
+	s->table.rows = std::clamp<long long>(
+		obs_data_get_int(settings, SETTING_TABLE_ROWS), 0,
+		TABLE_MAX_ROWS);
+	s->table.stride = std::clamp<long long>(
+		obs_data_get_int(settings, SETTING_TABLE_STRIDE), 0,
+		TABLE_MAX_STRIDE);
+	if (!s->table.parseColumns(
+		    obs_data_get_string(settings, SETTING_TABLE_COLUMNS)))
+		s->table.rows = 0;
+	s->shown.clear();
+}
+
+static void *scoreboard_text_create(obs_data_t *settings, obs_source_t *source)
+{
+	auto s = new scoreboard_text;
+	s->source = source;
+	s->width = 0;
+	s->height = 0;
+
+	scoreboard_text_update(s, settings);
+
+	return s;
+}
+
+static void scoreboard_text_destroy(void *data)
+{
+	delete (scoreboard_text *)data;
+}
+
+static void scoreboard_text_defaults(obs_data_t *settings)
+{
+	OBSDataAutoRelease font = obs_data_create();
+	obs_data_set_default_string(font, "face", "Arial");
+	obs_data_set_default_int(font, "size", 72);
+	obs_data_set_default_obj(settings, SETTING_FONT, font);
+
+	obs_data_set_default_int(settings, SETTING_ITEMNO, 1);
+	obs_data_set_default_int(settings, SETTING_LENGTH, 1);
+	obs_data_set_default_int(settings, SETTING_COLOR, 0xFFFFFFFF);
+	obs_data_set_default_bool(settings, SETTING_FIXED_PITCH, true);
+	obs_data_set_default_int(settings, SETTING_TABLE_STRIDE, 1);
+}
+
+static obs_properties_t *scoreboard_text_properties(void *data)
+{
+	UNUSED_PARAMETER(data);
+
+	obs_properties_t *props = obs_properties_create();
+
+	obs_properties_add_int(props, SETTING_ITEMNO,
+			       T("OBSScoreboard.Binding.ItemNo"), 1, 99999, 1);
+	obs_properties_add_int(props, SETTING_LENGTH,
+			       T("OBSScoreboard.Binding.Length"), 1, 255, 1);
+	obs_properties_add_font(props, SETTING_FONT,
+				T("OBSScoreboard.TextSource.Font"));
+	obs_properties_add_color_alpha(props, SETTING_COLOR,
+				       T("OBSScoreboard.TextSource.Color"));
+	obs_properties_add_bool(props, SETTING_TRIM_STR,
+				T("OBSScoreboard.Binding.TrimStr"));
+	obs_properties_add_bool(props, SETTING_FIXED_PITCH,
+				T("OBSScoreboard.TextSource.FixedPitch"));
+	obs_properties_add_bool(props, SETTING_CLOCK_MODE,
+				T("OBSScoreboard.Binding.ClockMode"));
+	obs_properties_add_int(props, SETTING_TABLE_ROWS,
+			       T("OBSScoreboard.Binding.TableRows"), 0,
+			       TABLE_MAX_ROWS, 1);
+	obs_properties_add_int(props, SETTING_TABLE_STRIDE,
+			       T("OBSScoreboard.Binding.TableStride"), 1,
+			       TABLE_MAX_STRIDE, 1);
+	obs_properties_add_text(props, SETTING_TABLE_COLUMNS,
+				T("OBSScoreboard.Binding.TableColumns"),
+				OBS_TEXT_DEFAULT);
+
+	return props;
+}
+
+static void scoreboard_text_tick(void *data, float seconds)
+{
+	UNUSED_PARAMETER(seconds);
+
+	auto s = (scoreboard_text *)data;
+
+	std::lock_guard<std::mutex> lock(s->mutex);
+
+	if (s->table.isTable()) {
+		uint32_t span = s->table.span();
+		if (receiver)
+			receiver->copyRange(s->item_number, span, s->block);
+		else
+			s->block.assign(span, ' ');
+
+		// only laid out again once something in the block changes
+		if (s->block != s->shown) {
+			s->shown.swap(s->block);
+			s->table.render(s->shown, s->trim_str, s->value);
+		}
+		s->text = s->value;
+	} else {
+		// read straight from the score table - no settings, no shaping
+		if (receiver)
+			receiver->copyRange(s->item_number, s->field_length,
+					    s->value);
+		else
+			s->value.assign(s->field_length, ' ');
+		s->text = s->value;
+	}
+
+	if (s->clock_mode && !s->table.isTable()) {
+		// this runs every rendered frame, so the clock moves smoothly
+		uint64_t now = os_gettime_ns();
+		s->clock.sync(s->value, now);
+		s->text = s->clock.format(now);
+	}
+
+	if (s->trim_str && !s->table.isTable()) {
+		while (!s->text.empty() && s->text.front() == ' ')
+			s->text.remove_prefix(1);
+		while (!s->text.empty() && s->text.back() == ' ')
+			s->text.remove_suffix(1);
+	}
+
+	if (!s->atlas) {
+		s->width = s->height = 0;
+		return;
+	}
+
+	// a fixed pitch keeps the source the same size as digits change
+	uint32_t lines = 1, lineWidth = 0;
+	s->width = 0;
+	for (char c : s->text) {
+		if (c == '\n') {
+			s->width = std::max(s->width, lineWidth);
+			lineWidth = 0;
+			lines++;
+			continue;
+		}
+		lineWidth += s->fixed_pitch ? s->atlas->pitch
+					    : s->atlas->glyph(c).advance;
+	}
+	s->width = std::max(s->width, lineWidth);
+	s->height = s->atlas->height * lines;
+}
+
+static void scoreboard_text_render(void *data, gs_effect_t *effect)
+{
+	auto s = (scoreboard_text *)data;
+
+	std::lock_guard<std::mutex> lock(s->mutex);
+
+	if (!s->atlas || s->text.empty())
+		return;
+
+	GlyphAtlas &atlas = *s->atlas;
+	gs_texture_t *tex = atlas.texture();
+	if (!tex)
+		return;
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"),
+			      tex);
+
+	uint32_t x = 0, y = 0;
+	for (char c : s->text) {
+		if (c == '\n') {
+			x = 0;
+			y += atlas.height;
+			continue;
+		}
+
+		const Glyph &glyph = atlas.glyph(c);
+
+		// centre each glyph in its cell when the pitch is fixed
+		uint32_t offset = 0;
+		if (s->fixed_pitch && glyph.advance < atlas.pitch)
+			offset = (atlas.pitch - glyph.advance) / 2;
+
+		if (c != ' ') {
+			gs_matrix_push();
+			gs_matrix_translate3f((float)(x + offset), (float)y,
+					      0.0f);
+			gs_draw_sprite_subregion(tex, 0, glyph.x, glyph.y,
+						 glyph.cx, atlas.height);
+			gs_matrix_pop();
+		}
+
+		x += s->fixed_pitch ? atlas.pitch : glyph.advance;
+	}
+
+	gs_blend_state_pop();
+}
+
+static uint32_t scoreboard_text_width(void *data)
+{
+	return ((scoreboard_text *)data)->width;
+}
+
+static uint32_t scoreboard_text_height(void *data)
+{
+	return ((scoreboard_text *)data)->height;
+}
+
+void register_scoreboard_text_source()
+{
+	static obs_source_info info = {};
+
+	info.id = SCOREBOARD_TEXT_ID;
+	info.type = OBS_SOURCE_TYPE_INPUT;
+	info.output_flags = OBS_SOURCE_VIDEO;
+	info.icon_type = OBS_ICON_TYPE_TEXT;
+	info.get_name = scoreboard_text_get_name;
+	info.create = scoreboard_text_create;
+	info.destroy = scoreboard_text_destroy;
+	info.update = scoreboard_text_update;
+	info.get_defaults = scoreboard_text_defaults;
+	info.get_properties = scoreboard_text_properties;
+	info.video_tick = scoreboard_text_tick;
+	info.video_render = scoreboard_text_render;
+	info.get_width = scoreboard_text_width;
+	info.get_height = scoreboard_text_height;
+
+	obs_register_source(&info);
+}
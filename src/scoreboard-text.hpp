@@ -0,0 +1,56 @@
+#ifndef OBSSB_SCOREBOARD_TEXT_HPP
+#define OBSSB_SCOREBOARD_TEXT_HPP
+
+#include <obs.h>
+
+#include <memory>
+#include <string>
+
+#include <QImage>
+
+#define SCOREBOARD_TEXT_ID "scoreboard_text"
+
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST '~'
+#define GLYPH_COUNT (GLYPH_LAST - GLYPH_FIRST + 1)
+
+struct Glyph {
+	uint32_t x;
+	uint32_t y;
+	uint32_t cx;
+	uint32_t advance;
+};
+
+// Printable ASCII rasterized once for a given font and color. Atlases are
+// shared between every source using the same font, and the texture is only
+// created the first time one of them renders.
+class GlyphAtlas {
+public:
+	GlyphAtlas(obs_data_t *font, uint32_t color);
+	~GlyphAtlas();
+
+	static std::shared_ptr<GlyphAtlas> get(obs_data_t *font,
+					       uint32_t color);
+
+	// must be called from the graphics thread
+	gs_texture_t *texture();
+
+	inline const Glyph &glyph(char c) const
+	{
+		if (c < GLYPH_FIRST || c > GLYPH_LAST)
+			c = ' ';
+		return glyphs[c - GLYPH_FIRST];
+	}
+
+	uint32_t height;
+	uint32_t pitch;
+
+private:
+	Glyph glyphs[GLYPH_COUNT];
+	QImage image;
+	gs_texture_t *tex;
+};
+
+void register_scoreboard_text_source();
+
+#endif // OBSSB_SCOREBOARD_TEXT_HPP
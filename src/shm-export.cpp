@@ -0,0 +1,234 @@
+#include <obs.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "receiver.hpp"
+#include "shm-export.hpp"
+
+#include "plugin-macros.generated.h"
+
+// a log entry costs less than copying a short gap
+#define SHM_MERGE_GAP 16
+
+// a batch touching more ranges than this is logged as one, so a reader
+// doesn't fall out of the log because of a single snapshot
+#define SHM_MAX_BATCH_RANGES (OBSSB_SHM_LOG_SIZE / 4)
+
+#define SHM_HEADER_SIZE \
+	((sizeof(obssb_shm_header) + 63) / 64 * 64)
+
+ShmExport::ShmExport(Receiver *receiver_) : QObject(receiver_)
+{
+	receiver = receiver_;
+	fd = -1;
+	header = nullptr;
+	mappedSize = 0;
+}
+
+ShmExport::~ShmExport()
+{
+	close();
+}
+
+void ShmExport::configure(const QString &name_)
+{
+	std::string wanted = name_.trimmed().toStdString();
+
+	// POSIX names are a slash and a name without any more slashes
+	if (!wanted.empty() && wanted[0] == '/')
+		wanted.erase(0, 1);
+
+	if (wanted == name && header)
+		return;
+
+	close();
+	changed.clear();
+
+	if (wanted.empty())
+		return;
+
+	if (wanted.find('/') != std::string::npos || wanted.size() > NAME_MAX) {
+		blog(LOG_WARNING, "invalid shared memory name: %s",
+		     wanted.c_str());
+		return;
+	}
+
+	if (!open(wanted))
+		return;
+
+	blog(LOG_INFO, "exporting score table to shared memory /%s",
+	     name.c_str());
+
+	// readers start with the whole table
+	write({{0, SCORE_TABLE_MAX_CAPACITY}});
+}
+
+void ShmExport::markChanged(size_t offset, size_t length)
+{
+	if (header && length)
+		changed.emplace_back(offset, offset + length);
+}
+
+void ShmExport::flush()
+{
+	if (!header)
+		return;
+
+	// a resize is news even if nothing was written
+	size_t capacity = receiver->getScoreTable().capacity();
+	if (changed.empty() && capacity == header->capacity)
+		return;
+
+	std::sort(changed.begin(), changed.end());
+
+	std::vector<std::pair<size_t, size_t>> merged;
+	for (auto &range : changed) {
+		if (!merged.empty() &&
+		    range.first <= merged.back().second + SHM_MERGE_GAP)
+			merged.back().second =
+				std::max(merged.back().second, range.second);
+		else
+			merged.push_back(range);
+	}
+	changed.clear();
+
+	if (merged.size() > SHM_MAX_BATCH_RANGES)
+		merged = {{merged.front().first, merged.back().second}};
+
+	write(merged);
+}
+
+#ifndef _WIN32
+
+bool ShmExport::open(const std::string &name_)
+{
+	std::string path = "/" + name_;
+
+	// left behind by an instance that didn't get to close it
+	shm_unlink(path.c_str());
+
+	fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		blog(LOG_WARNING, "failed to create shared memory %s: %s",
+		     path.c_str(), strerror(errno));
+		return false;
+	}
+
+	size_t size = SHM_HEADER_SIZE + SCORE_TABLE_MAX_CAPACITY;
+	void *mapped = MAP_FAILED;
+	if (ftruncate(fd, (off_t)size) == 0)
+		mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			      fd, 0);
+
+	if (mapped == MAP_FAILED) {
+		blog(LOG_WARNING, "failed to map shared memory %s: %s",
+		     path.c_str(), strerror(errno));
+		::close(fd);
+		fd = -1;
+		shm_unlink(path.c_str());
+		return false;
+	}
+
+	name = name_;
+	mappedSize = size;
+	header = (obssb_shm_header *)mapped;
+
+	// the segment starts out zeroed, so only the layout needs filling in;
+	// the magic goes last for anyone who opens it straight away
+	header->layout = OBSSB_SHM_LAYOUT;
+	header->header_size = (uint32_t)SHM_HEADER_SIZE;
+	header->max_table = SCORE_TABLE_MAX_CAPACITY;
+	__atomic_store_n(&header->magic, OBSSB_SHM_MAGIC, __ATOMIC_RELEASE);
+	return true;
+}
+
+void ShmExport::close()
+{
+	if (!header)
+		return;
+
+	// under the seqlock, so waiting readers are woken to see it
+	uint32_t seq = header->seq;
+	__atomic_store_n(&header->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	header->closed = 1;
+	__atomic_store_n(&header->seq, seq + 2, __ATOMIC_RELEASE);
+#ifdef __linux__
+	syscall(SYS_futex, &header->seq, FUTEX_WAKE, INT_MAX, nullptr,
+		nullptr, 0);
+#endif
+
+	munmap(header, mappedSize);
+	::close(fd);
+	shm_unlink(("/" + name).c_str());
+
+	header = nullptr;
+	fd = -1;
+	name.clear();
+}
+
+void ShmExport::write(const std::vector<std::pair<size_t, size_t>> &ranges)
+{
+	const ScoreTable &table = receiver->getScoreTable();
+	size_t capacity = table.capacity();
+	char *dest = (char *)header + header->header_size;
+	uint64_t version = header->version + 1;
+
+	// odd until everything's in place
+	uint32_t seq = header->seq;
+	__atomic_store_n(&header->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	for (auto &range : ranges) {
+		size_t end = std::min(range.second, capacity);
+		if (range.first >= end)
+			continue;
+
+		memcpy(dest + range.first, table.data() + range.first,
+		       end - range.first);
+
+		obssb_shm_range &entry =
+			header->log[header->log_count % OBSSB_SHM_LOG_SIZE];
+		entry.version = version;
+		entry.offset = (uint32_t)range.first;
+		entry.length = (uint32_t)(end - range.first);
+		header->log_count++;
+	}
+
+	header->capacity = (uint32_t)capacity;
+	header->version = version;
+	header->updated_ns = os_gettime_ns();
+
+	__atomic_store_n(&header->seq, seq + 2, __ATOMIC_RELEASE);
+
+	// cheaper than keeping count of who's waiting, at a wake per batch
+#ifdef __linux__
+	syscall(SYS_futex, &header->seq, FUTEX_WAKE, INT_MAX, nullptr,
+		nullptr, 0);
+#endif
+}
+
+#else
+
+bool ShmExport::open(const std::string &)
+{
+	blog(LOG_WARNING, "shared memory export isn't available on Windows");
+	return false;
+}
+
+void ShmExport::close() {}
+
+void ShmExport::write(const std::vector<std::pair<size_t, size_t>> &) {}
+
+#endif
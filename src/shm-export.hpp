@@ -0,0 +1,52 @@
+#ifndef OBSSB_SHM_EXPORT_HPP
+#define OBSSB_SHM_EXPORT_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "obs-scoreboard-shm.h"
+
+class Receiver;
+
+// Mirrors the receiver's score table into a POSIX shared memory segment,
+// laid out as in obs-scoreboard-shm.h, so other programs on the machine can
+// read it in place. Ranges changed in a batch of packets are copied in under
+// the seqlock when the batch is done, the way the relay sends them. Not
+// available on Windows.
+class ShmExport : public QObject {
+	Q_OBJECT
+
+public:
+	explicit ShmExport(Receiver *receiver);
+	~ShmExport();
+
+	// an empty name turns the export off
+	void configure(const QString &name);
+
+	inline bool isEnabled() const { return header != nullptr; }
+
+	void markChanged(size_t offset, size_t length);
+
+	// writes everything marked since the last flush
+	void flush();
+
+private:
+	Receiver *receiver;
+	std::string name;
+	int fd;
+	obssb_shm_header *header;
+	size_t mappedSize;
+
+	// [begin, end) ranges, merged on flush
+	std::vector<std::pair<size_t, size_t>> changed;
+
+	bool open(const std::string &name);
+	void close();
+	void write(const std::vector<std::pair<size_t, size_t>> &ranges);
+};
+
+#endif // OBSSB_SHM_EXPORT_HPP
@@ -0,0 +1,461 @@
+#ifndef OBSSB_SIDECAR_HPP
+#define OBSSB_SIDECAR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "score-table.hpp"
+
+// Sidecar files record the score table alongside an OBS recording, so graphics
+// can be rebuilt and footage searched by game state afterwards:
+//
+//   header:   "OSBS" | version (4) | started, unix ms (8)
+//   records:  type (1) | ...
+//     keyframe: time (v) | length (v) | the whole table
+//     change:   time since the previous record (v) | offset (v) |
+//               length (v) | data
+//     index:    count (v) | count x [time delta (v) | position delta (v)]
+//   trailer:  position of the index (8) | "OSBI" | 0 (4)
+//
+// (v) is an unsigned LEB128 varint, fixed-size integers are little-endian,
+// and times are microseconds on the recording's timeline. Changes only carry
+// the bytes that actually changed. Keyframes come often enough that the
+// changes after one never add up to more than the table itself, and the
+// index lists them all, so any moment can be rebuilt with a binary search
+// and a short replay. A file that was never finished has no index, and the
+// reader builds one by scanning.
+//
+// This header only needs the standard library, so tools can take it as it is.
+
+#define SIDECAR_MAGIC "OSBS"
+#define SIDECAR_INDEX_MAGIC "OSBI"
+#define SIDECAR_MAGIC_LEN 4
+#define SIDECAR_VERSION 1
+#define SIDECAR_HEADER_LEN (SIDECAR_MAGIC_LEN + 4 + 8)
+#define SIDECAR_TRAILER_LEN (8 + SIDECAR_MAGIC_LEN + 4)
+
+#define SIDECAR_RECORD_KEYFRAME 1
+#define SIDECAR_RECORD_CHANGE 2
+#define SIDECAR_RECORD_INDEX 3
+
+// changed bytes closer than this go in one record, which is smaller than two
+#define SIDECAR_MERGE_GAP 6
+
+// a table that barely changes still gets a keyframe this often
+#define SIDECAR_KEYFRAME_MAX_US (60 * 1000000ULL)
+
+namespace sidecar {
+
+inline void appendVarint(std::string &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back((char)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+
+inline void appendFixed(std::string &out, uint64_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		out.push_back((char)(value >> (i * 8)));
+}
+
+inline bool readVarint(const std::string_view &data, size_t &pos,
+		       uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+		uint8_t byte = data[pos++];
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+inline uint64_t readFixed(const char *p, int bytes)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < bytes; i++)
+		value |= (uint64_t)(uint8_t)p[i] << (i * 8);
+	return value;
+}
+
+} // namespace sidecar
+
+// Turns a stream of table writes into sidecar records. It keeps its own copy
+// of the table to find out which bytes really changed; the encoded bytes
+// pile up until they're taken to be written out.
+class SidecarEncoder {
+public:
+	SidecarEncoder() : flushed(0), lastTime(0), keyframeTime(0),
+			   sinceKeyframe(0) {}
+
+	// the header and a keyframe of the table as it stands
+	void begin(int64_t started_ms, const std::string_view &initial)
+	{
+		pending.clear();
+		index.clear();
+		flushed = 0;
+		lastTime = 0;
+		table = initial;
+
+		pending.append(SIDECAR_MAGIC, SIDECAR_MAGIC_LEN);
+		sidecar::appendFixed(pending, SIDECAR_VERSION, 4);
+		sidecar::appendFixed(pending, (uint64_t)started_ms, 8);
+
+		keyframe(0);
+	}
+
+	void update(uint64_t time_us, size_t offset,
+		    const std::string_view &data)
+	{
+		// the timeline never runs backwards
+		time_us = std::max(time_us, lastTime);
+
+		if (table.size() < offset + data.size())
+			table.resize(offset + data.size(), ' ');
+
+		size_t i = 0;
+		while (i < data.size()) {
+			if (data[i] == table[offset + i]) {
+				i++;
+				continue;
+			}
+
+			// carry on through short unchanged stretches
+			size_t begin = i, end = i + 1;
+			for (size_t j = end; j < data.size(); j++) {
+				if (data[j] == table[offset + j])
+					continue;
+				if (j - end >= SIDECAR_MERGE_GAP)
+					break;
+				end = j + 1;
+			}
+
+			change(time_us, offset + begin,
+			       data.substr(begin, end - begin));
+			i = end;
+		}
+
+		if (sinceKeyframe > table.size() ||
+		    (sinceKeyframe &&
+		     time_us - keyframeTime >= SIDECAR_KEYFRAME_MAX_US))
+			keyframe(time_us);
+	}
+
+	// appends the index and trailer; nothing more can be added after this
+	void end()
+	{
+		uint64_t position = flushed + pending.size();
+
+		pending.push_back(SIDECAR_RECORD_INDEX);
+		sidecar::appendVarint(pending, index.size());
+
+		uint64_t time = 0, at = 0;
+		for (auto &entry : index) {
+			sidecar::appendVarint(pending, entry.first - time);
+			sidecar::appendVarint(pending, entry.second - at);
+			time = entry.first;
+			at = entry.second;
+		}
+
+		sidecar::appendFixed(pending, position, 8);
+		pending.append(SIDECAR_INDEX_MAGIC, SIDECAR_MAGIC_LEN);
+		sidecar::appendFixed(pending, 0, 4);
+	}
+
+	// hands over what's been encoded since last time
+	void take(std::string &out)
+	{
+		out.swap(pending);
+		pending.clear();
+		flushed += out.size();
+	}
+
+private:
+	std::string table;
+	std::string pending;
+	uint64_t flushed;
+	uint64_t lastTime;
+
+	uint64_t keyframeTime;
+	size_t sinceKeyframe;
+	std::vector<std::pair<uint64_t, uint64_t>> index;
+
+	void keyframe(uint64_t time_us)
+	{
+		index.emplace_back(time_us, flushed + pending.size());
+
+		pending.push_back(SIDECAR_RECORD_KEYFRAME);
+		sidecar::appendVarint(pending, time_us);
+		sidecar::appendVarint(pending, table.size());
+		pending.append(table);
+
+		lastTime = time_us;
+		keyframeTime = time_us;
+		sinceKeyframe = 0;
+	}
+
+	void change(uint64_t time_us, size_t offset,
+		    const std::string_view &data)
+	{
+		size_t start = pending.size();
+
+		pending.push_back(SIDECAR_RECORD_CHANGE);
+		sidecar::appendVarint(pending, time_us - lastTime);
+		sidecar::appendVarint(pending, offset);
+		sidecar::appendVarint(pending, data.size());
+		pending.append(data);
+
+		std::copy(data.begin(), data.end(), table.begin() + offset);
+		lastTime = time_us;
+		sinceKeyframe += pending.size() - start;
+	}
+};
+
+// Reads a whole sidecar file into memory, and answers what the table looked
+// like at any point in the recording, or what changed over a stretch of it.
+class SidecarReader {
+public:
+	struct Change {
+		uint64_t time_us;
+		size_t offset;
+		std::string_view data;
+	};
+
+	// returns an error, or nullptr once the file is ready to be read
+	const char *open(const std::string &path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return "can't open file";
+
+		data.assign(std::istreambuf_iterator<char>(file),
+			    std::istreambuf_iterator<char>());
+		return load();
+	}
+
+	// as open, for a file that's already in memory
+	const char *load(std::string contents)
+	{
+		data = std::move(contents);
+		return load();
+	}
+
+	inline int64_t startedMs() const { return started_ms; }
+
+	// the time of the last record
+	inline uint64_t duration() const { return end_us; }
+
+	// the table as it was at time_us, replayed from the keyframe before it
+	void stateAt(uint64_t time_us, std::string &table) const
+	{
+		table.clear();
+
+		size_t pos = keyframeBefore(time_us);
+		uint64_t time = 0;
+		uint8_t type;
+		size_t table_len = 0;
+		Change change;
+
+		while (next(pos, time, type, table_len, change) &&
+		       change.time_us <= time_us) {
+			size_t end = change.offset + change.data.size();
+			if (table.size() < end)
+				table.resize(end, ' ');
+			std::copy(change.data.begin(), change.data.end(),
+				  table.begin() + change.offset);
+		}
+	}
+
+	// calls back with every change in [from_us, to_us), until the
+	// callback returns false. Keyframes aren't changes and are left out.
+	template <typename Callback>
+	void changes(uint64_t from_us, uint64_t to_us,
+		     Callback &&callback) const
+	{
+		size_t pos = keyframeBefore(from_us);
+		uint64_t time = 0;
+		uint8_t type;
+		size_t table_len = 0;
+		Change change;
+
+		while (next(pos, time, type, table_len, change) &&
+		       change.time_us < to_us) {
+			if (type == SIDECAR_RECORD_CHANGE &&
+			    change.time_us >= from_us && !callback(change))
+				break;
+		}
+	}
+
+private:
+	std::string data;
+	int64_t started_ms = 0;
+	uint64_t end_us = 0;
+
+	// time and position of every keyframe, in order
+	std::vector<std::pair<uint64_t, size_t>> keyframes;
+
+	const char *load()
+	{
+		std::string_view view(data);
+		keyframes.clear();
+		end_us = 0;
+
+		if (view.size() < SIDECAR_HEADER_LEN ||
+		    view.compare(0, SIDECAR_MAGIC_LEN, SIDECAR_MAGIC) != 0)
+			return "not a scoreboard sidecar";
+		if (sidecar::readFixed(data.data() + SIDECAR_MAGIC_LEN, 4) !=
+		    SIDECAR_VERSION)
+			return "unsupported sidecar version";
+
+		started_ms = (int64_t)sidecar::readFixed(
+			data.data() + SIDECAR_MAGIC_LEN + 4, 8);
+
+		if (!loadIndex())
+			scan();
+
+		if (keyframes.empty())
+			return "no keyframes";
+		return nullptr;
+	}
+
+	// the index at the end, if the file was finished
+	bool loadIndex()
+	{
+		std::string_view view(data);
+		if (view.size() < SIDECAR_HEADER_LEN + SIDECAR_TRAILER_LEN)
+			return false;
+
+		size_t trailer = view.size() - SIDECAR_TRAILER_LEN;
+		if (view.compare(trailer + 8, SIDECAR_MAGIC_LEN,
+				 SIDECAR_INDEX_MAGIC) != 0)
+			return false;
+
+		size_t pos = sidecar::readFixed(data.data() + trailer, 8);
+		if (pos < SIDECAR_HEADER_LEN || pos >= trailer ||
+		    view[pos++] != SIDECAR_RECORD_INDEX)
+			return false;
+
+		std::string_view body = view.substr(0, trailer);
+		uint64_t count, time = 0, at = 0;
+		if (!sidecar::readVarint(body, pos, count))
+			return false;
+
+		std::vector<std::pair<uint64_t, size_t>> entries;
+		for (uint64_t i = 0; i < count; i++) {
+			uint64_t timeDelta, atDelta;
+			if (!sidecar::readVarint(body, pos, timeDelta) ||
+			    !sidecar::readVarint(body, pos, atDelta))
+				return false;
+
+			time += timeDelta;
+			at += atDelta;
+			if (at < SIDECAR_HEADER_LEN || at >= trailer ||
+			    (uint8_t)view[at] != SIDECAR_RECORD_KEYFRAME)
+				return false;
+			entries.emplace_back(time, (size_t)at);
+		}
+		if (entries.empty())
+			return false;
+
+		keyframes.swap(entries);
+
+		// the records after the last keyframe say how long it runs
+		pos = keyframes.back().second;
+		time = 0;
+		uint8_t type;
+		size_t table_len = 0;
+		Change change;
+		while (next(pos, time, type, table_len, change))
+			end_us = change.time_us;
+		return true;
+	}
+
+	// finds the keyframes the slow way, up to anything truncated
+	void scan()
+	{
+		size_t pos = SIDECAR_HEADER_LEN;
+		uint64_t time = 0;
+		uint8_t type;
+		size_t table_len = 0;
+		Change change;
+
+		for (size_t start = pos;
+		     next(pos, time, type, table_len, change); start = pos) {
+			if (type == SIDECAR_RECORD_KEYFRAME)
+				keyframes.emplace_back(change.time_us, start);
+			end_us = change.time_us;
+		}
+	}
+
+	// where to start replaying from for time_us
+	size_t keyframeBefore(uint64_t time_us) const
+	{
+		typedef std::pair<uint64_t, size_t> Keyframe;
+		auto it = std::upper_bound(keyframes.begin(), keyframes.end(),
+					   time_us,
+					   [](uint64_t time, const Keyframe &k) {
+						   return time < k.first;
+					   });
+		if (it != keyframes.begin())
+			--it;
+		return it == keyframes.end() ? data.size() : it->second;
+	}
+
+	// decodes the record at pos and moves past it. A keyframe comes back
+	// as a change covering the whole table, and sets table_len, which the
+	// changes after it have to fit in. False at the index, the end, or
+	// anything truncated or out of bounds.
+	bool next(size_t &pos, uint64_t &time, uint8_t &type, size_t &table_len,
+		  Change &change) const
+	{
+		std::string_view view(data);
+		if (pos >= view.size())
+			return false;
+
+		size_t at = pos;
+		type = view[at++];
+
+		uint64_t offset = 0, length;
+		if (type == SIDECAR_RECORD_KEYFRAME) {
+			if (!sidecar::readVarint(view, at, time))
+				return false;
+		} else if (type == SIDECAR_RECORD_CHANGE) {
+			uint64_t delta;
+			if (!sidecar::readVarint(view, at, delta) ||
+			    !sidecar::readVarint(view, at, offset))
+				return false;
+			time += delta;
+		} else {
+			return false;
+		}
+
+		if (!sidecar::readVarint(view, at, length) ||
+		    view.size() - at < length)
+			return false;
+
+		if (type == SIDECAR_RECORD_KEYFRAME) {
+			if (length > SCORE_TABLE_MAX_CAPACITY)
+				return false;
+			table_len = (size_t)length;
+		} else if (offset > table_len || length > table_len - offset) {
+			return false;
+		}
+
+		change = {time, (size_t)offset, view.substr(at, length)};
+		pos = at + length;
+		return true;
+	}
+};
+
+#endif // OBSSB_SIDECAR_HPP
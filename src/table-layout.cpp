@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "table-layout.hpp"
+
+TableLayout::TableLayout()
+{
+	rows = 0;
+	stride = 0;
+}
+
+uint32_t TableLayout::span() const
+{
+	if (!rows)
+		return 0;
+
+	uint64_t width = 0;
+	for (int32_t column : columns)
+		width += (uint64_t)std::abs(column);
+	if (columns.empty())
+		width = stride;
+
+	// saturates well past anything the table can hold, so inBounds()
+	// refuses the binding
+	uint64_t span = (uint64_t)(rows - 1) * stride + width;
+	return (uint32_t)std::min<uint64_t>(span, UINT32_MAX);
+}
+
+bool TableLayout::parseColumns(const std::string &str)
+{
+	std::vector<int32_t> parsed;
+	const char *p = str.c_str();
+
+	while (*p) {
+		while (*p == ' ')
+			p++;
+		if (!*p)
+			break;
+
+		char *end;
+		long width = strtol(p, &end, 10);
+		if (end == p || !width ||
+		    std::abs(width) > TABLE_MAX_COLUMN_WIDTH ||
+		    parsed.size() == TABLE_MAX_COLUMNS)
+			return false;
+		parsed.push_back((int32_t)width);
+
+		p = end;
+		while (*p == ' ')
+			p++;
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return false;
+	}
+
+	columns = std::move(parsed);
+	return true;
+}
+
+std::string TableLayout::formatColumns() const
+{
+	std::string str;
+	for (int32_t column : columns) {
+		if (!str.empty())
+			str += ',';
+		str += std::to_string(column);
+	}
+	return str;
+}
+
+// width bytes of the block from offset, padded out with blanks
+static void appendCell(std::string &out, std::string_view block,
+		       size_t offset, size_t width)
+{
+	size_t available = offset < block.size() ? block.size() - offset : 0;
+	size_t length = std::min(width, available);
+	out.append(block.data() + offset, length);
+	out.append(width - length, ' ');
+}
+
+void TableLayout::render(std::string_view block, bool trim,
+			 std::string &out) const
+{
+	out.clear();
+
+	for (uint32_t row = 0; row < rows; row++) {
+		if (row)
+			out += '\n';
+
+		size_t line = out.size();
+		size_t offset = (size_t)row * stride;
+
+		if (columns.empty())
+			appendCell(out, block, offset, stride);
+
+		bool first = true;
+		for (int32_t column : columns) {
+			if (column < 0) {
+				offset += -column;
+				continue;
+			}
+
+			if (!first)
+				out += ' ';
+			first = false;
+
+			appendCell(out, block, offset, column);
+			offset += column;
+		}
+
+		if (trim) {
+			while (out.size() > line && out.back() == ' ')
+				out.pop_back();
+		}
+	}
+}
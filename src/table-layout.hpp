@@ -0,0 +1,43 @@
+#ifndef OBSSB_TABLE_LAYOUT_HPP
+#define OBSSB_TABLE_LAYOUT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define TABLE_MAX_ROWS 255
+#define TABLE_MAX_STRIDE 4096
+#define TABLE_MAX_COLUMNS 64
+#define TABLE_MAX_COLUMN_WIDTH 255
+
+// A block of the score table read as rows of fixed-width columns, such as a
+// team's player stats: the rows start stride bytes apart, and each one is
+// split into columns of the given widths, one after the other. A negative
+// width skips that many bytes, and no columns at all makes the whole stride
+// one column. The block is shown as a line of text for each row, with a
+// space between columns.
+class TableLayout {
+public:
+	TableLayout();
+
+	inline bool isTable() const { return rows > 0; }
+
+	// bytes from the start of the first row to the end of the last
+	uint32_t span() const;
+
+	// columns as written in the binding dialog, e.g. "2,-1,3,3"; false
+	// if that isn't a list of widths
+	bool parseColumns(const std::string &str);
+	std::string formatColumns() const;
+
+	// block is span() bytes from the table, and anything short of that
+	// reads as blank. With trim, spaces are taken off the end of each line.
+	void render(std::string_view block, bool trim, std::string &out) const;
+
+	uint32_t rows;
+	uint32_t stride;
+	std::vector<int32_t> columns;
+};
+
+#endif // OBSSB_TABLE_LAYOUT_HPP
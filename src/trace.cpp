@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "trace.hpp"
+
+#define TRACE_CAPACITY 65536
+#define TRACE_DETAIL_LEN 48
+
+struct TraceEvent {
+	// odd while the slot is being written, see traceRecord
+	std::atomic<uint64_t> seq;
+	const char *name;
+	char detail[TRACE_DETAIL_LEN];
+	uint64_t start_ns;
+	uint64_t end_ns;
+	uint32_t tid;
+};
+
+std::atomic<bool> traceEnabled(false);
+
+static TraceEvent events[TRACE_CAPACITY];
+static std::atomic<uint64_t> writeIndex(0);
+static std::atomic<uint32_t> nextThreadId(1);
+
+static uint32_t threadId()
+{
+	thread_local uint32_t id = nextThreadId.fetch_add(1);
+	return id;
+}
+
+void traceSetEnabled(bool enabled)
+{
+	traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void traceRecord(const char *name, const char *detail, uint64_t start_ns,
+		 uint64_t end_ns)
+{
+	// claiming a slot is the only shared write, so producers never wait
+	uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+	TraceEvent &event = events[index % TRACE_CAPACITY];
+
+	event.seq.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	event.name = name;
+	if (detail) {
+		strncpy(event.detail, detail, TRACE_DETAIL_LEN - 1);
+		event.detail[TRACE_DETAIL_LEN - 1] = 0;
+	} else {
+		event.detail[0] = 0;
+	}
+	event.start_ns = start_ns;
+	event.end_ns = end_ns;
+	event.tid = threadId();
+
+	event.seq.store(index * 2 + 2, std::memory_order_release);
+}
+
+static void writeEscaped(FILE *file, const char *str)
+{
+	for (; *str; str++) {
+		unsigned char c = (unsigned char)*str;
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(file, "\\u%04x", c);
+		else
+			fputc(c, file);
+	}
+}
+
+bool traceDump(const char *path)
+{
+	FILE *file = os_fopen(path, "wb");
+	if (!file)
+		return false;
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+
+	uint64_t end = writeIndex.load(std::memory_order_acquire);
+	uint64_t begin = end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+	bool first = true;
+
+	for (uint64_t index = begin; index < end; index++) {
+		TraceEvent &slot = events[index % TRACE_CAPACITY];
+
+		// skip slots that are mid-write or were overwritten meanwhile
+		uint64_t seq = slot.seq.load(std::memory_order_acquire);
+		if (seq != index * 2 + 2)
+			continue;
+
+		const char *name = slot.name;
+		char detail[TRACE_DETAIL_LEN];
+		memcpy(detail, slot.detail, sizeof(detail));
+		uint64_t start_ns = slot.start_ns;
+		uint64_t end_ns = slot.end_ns;
+		uint32_t tid = slot.tid;
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.seq.load(std::memory_order_relaxed) != seq)
+			continue;
+
+		detail[TRACE_DETAIL_LEN - 1] = 0;
+
+		fprintf(file,
+			"%s\n{\"name\":\"%s\",\"cat\":\"obs-scoreboard\","
+			"\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+			"\"dur\":%.3f",
+			first ? "" : ",", name, tid, start_ns / 1000.0,
+			(end_ns - start_ns) / 1000.0);
+
+		if (detail[0]) {
+			fputs(",\"args\":{\"detail\":\"", file);
+			writeEscaped(file, detail);
+			fputs("\"}", file);
+		}
+
+		fputc('}', file);
+		first = false;
+	}
+
+	fputs("\n]}\n", file);
+	fclose(file);
+
+	return true;
+}
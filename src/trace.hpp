@@ -0,0 +1,61 @@
+#ifndef OBSSB_TRACE_HPP
+#define OBSSB_TRACE_HPP
+
+// Scoped trace zones around the ingest and update pipeline. Zones are only
+// compiled in with ENABLE_TRACING, and even then record nothing until
+// recording is switched on, at which point they go into a fixed in-memory
+// ring that can be dumped as a Chrome/Perfetto trace.
+
+#ifdef ENABLE_TRACING
+
+#include <util/platform.h>
+
+#include <atomic>
+#include <cstdint>
+
+extern std::atomic<bool> traceEnabled;
+
+void traceSetEnabled(bool enabled);
+void traceRecord(const char *name, const char *detail, uint64_t start_ns,
+		 uint64_t end_ns);
+bool traceDump(const char *path);
+
+class TraceZone {
+public:
+	inline TraceZone(const char *name_, const char *detail_ = nullptr)
+	{
+		active = traceEnabled.load(std::memory_order_relaxed);
+		if (!active)
+			return;
+		name = name_;
+		detail = detail_;
+		start = os_gettime_ns();
+	}
+
+	inline ~TraceZone()
+	{
+		if (active)
+			traceRecord(name, detail, start, os_gettime_ns());
+	}
+
+private:
+	bool active;
+	const char *name;
+	const char *detail;
+	uint64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(...) \
+	TraceZone TRACE_CONCAT(traceZone, __LINE__)(__VA_ARGS__)
+
+#else
+
+#define TRACE_ZONE(...) \
+	do {            \
+	} while (0)
+
+#endif // ENABLE_TRACING
+
+#endif // OBSSB_TRACE_HPP
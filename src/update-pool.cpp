@@ -0,0 +1,200 @@
+#include <obs.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "update-pool.hpp"
+
+#include "plugin-macros.generated.h"
+
+// beyond this they'd only be waiting their turn at the same sources
+#define UPDATE_POOL_MAX_WORKERS 8
+
+UpdatePool::UpdatePool(Receiver *receiver_) : QObject(receiver_)
+{
+	receiver = receiver_;
+	stopping = false;
+}
+
+UpdatePool::~UpdatePool()
+{
+	configure(0);
+}
+
+void UpdatePool::configure(uint32_t workers)
+{
+	workers = std::min<uint32_t>(workers, UPDATE_POOL_MAX_WORKERS);
+	if (workers == threads.size())
+		return;
+
+	if (!threads.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto &thread : threads)
+			thread.join();
+		threads.clear();
+		stopping = false;
+	}
+
+	// whatever was queued has been applied by now
+	jobs.clear();
+	urgentQueue.clear();
+
+	// a single worker takes everything, urgent work first; otherwise the
+	// last one is kept for urgent work and the rest have a queue each
+	queues.assign(workers > 1 ? workers - 1 : workers, {});
+
+	for (size_t i = 0; i < workers; i++)
+		threads.emplace_back(&UpdatePool::run, this, i);
+
+	if (workers)
+		blog(LOG_INFO, "updating sources on %u threads", workers);
+}
+
+void UpdatePool::queue(obs_source_t *source, const BindingPtr &binding,
+		       std::string_view value, bool urgent)
+{
+	std::string uuid = obs_source_get_uuid(source);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	JobPtr &job = jobs[uuid];
+	if (!job) {
+		job = std::make_shared<Job>();
+		job->uuid = uuid;
+		job->urgent = false;
+		job->queued = false;
+		job->running = false;
+
+		// on its way out, so there's no point
+		job->source = OBSSource(source);
+		if (!job->source) {
+			jobs.erase(uuid);
+			return;
+		}
+	}
+
+	// only the latest value matters
+	auto it = std::find_if(
+		job->values.begin(), job->values.end(),
+		[&](const auto &entry) { return entry.first == binding; });
+	if (it != job->values.end())
+		it->second.assign(value);
+	else
+		job->values.emplace_back(binding, std::string(value));
+
+	bool wasUrgent = job->urgent;
+	job->urgent = wasUrgent || urgent;
+
+	// the worker that has it queues it again once it's done
+	if (job->running)
+		return;
+
+	if (!job->queued) {
+		enqueue(job);
+	} else if (job->urgent && !wasUrgent) {
+		// it jumps ahead, and is skipped where it was
+		urgentQueue.push_back(job);
+		wake.notify_all();
+	}
+}
+
+void UpdatePool::enqueue(const JobPtr &job)
+{
+	job->queued = true;
+
+	// the same source tends to go to the same worker
+	if (job->urgent)
+		urgentQueue.push_back(job);
+	else
+		queues[std::hash<std::string>()(job->uuid) % queues.size()]
+			.push_back(job);
+
+	// all of them, as the one woken might only take urgent work
+	wake.notify_all();
+}
+
+UpdatePool::JobPtr UpdatePool::take(size_t worker)
+{
+	auto claim = [](std::deque<JobPtr> &queue, bool back) -> JobPtr {
+		while (!queue.empty()) {
+			JobPtr job = back ? queue.back() : queue.front();
+			if (back)
+				queue.pop_back();
+			else
+				queue.pop_front();
+
+			if (job->queued) {
+				job->queued = false;
+				job->running = true;
+				return job;
+			}
+		}
+		return nullptr;
+	};
+
+	if (JobPtr job = claim(urgentQueue, false))
+		return job;
+
+	// the worker kept for urgent work
+	if (worker >= queues.size())
+		return nullptr;
+
+	if (JobPtr job = claim(queues[worker], false))
+		return job;
+
+	// from the back, away from where the owner is taking
+	for (size_t i = 1; i < queues.size(); i++) {
+		if (JobPtr job = claim(queues[(worker + i) % queues.size()],
+				       true))
+			return job;
+	}
+
+	return nullptr;
+}
+
+void UpdatePool::run(size_t worker)
+{
+	for (;;) {
+		JobPtr job;
+		std::vector<std::pair<BindingPtr, std::string>> values;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() {
+				return (job = take(worker)) || stopping;
+			});
+			if (!job)
+				return;
+
+			values.swap(job->values);
+			job->urgent = false;
+		}
+
+		uint64_t start = os_gettime_ns();
+		applyProperties(job->source, values);
+		uint64_t ns = os_gettime_ns() - start;
+
+		// metrics belong to the receiver's thread
+		Metrics *metrics = receiver->metrics;
+		OBSSource source = job->source;
+		QMetaObject::invokeMethod(
+			this,
+			[metrics, source, ns]() {
+				metrics->countSourceUpdate(source, ns);
+			},
+			Qt::QueuedConnection);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		job->running = false;
+
+		// more came in while it was being applied
+		if (!job->values.empty())
+			enqueue(job);
+		else
+			jobs.erase(job->uuid);
+	}
+}
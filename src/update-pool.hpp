@@ -0,0 +1,83 @@
+#ifndef OBSSB_UPDATE_POOL_HPP
+#define OBSSB_UPDATE_POOL_HPP
+
+#include <obs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+
+#include "receiver.hpp"
+
+// A few threads that apply property bindings to their sources, so a source
+// that's slow to update (a browser, a large image) doesn't hold up the
+// bindings behind it on the receiver's thread.
+//
+// Work is kept per source: a source is only ever updated by one worker at a
+// time, once for everything that's been queued for it, and a value still
+// waiting for its turn is replaced by a newer one for the same binding. Each
+// worker has a queue of its own, which sources are spread over by uuid, and
+// takes from the back of the others' when it runs out. Urgent work has a
+// lane that every worker looks at first; with more than one worker, the
+// last takes nothing else, so urgent work never waits behind a slow source
+// unless it's for that very source.
+class UpdatePool : public QObject {
+	Q_OBJECT
+
+public:
+	explicit UpdatePool(Receiver *receiver);
+	~UpdatePool();
+
+	// 0 stops the workers, once they've applied what they have left
+	void configure(uint32_t workers);
+
+	inline bool isRunning() const { return !threads.empty(); }
+
+	// sets the binding's property to value on a worker; from the
+	// receiver's thread
+	void queue(obs_source_t *source, const BindingPtr &binding,
+		   std::string_view value, bool urgent);
+
+private:
+	// everything waiting to be applied to one source
+	struct Job {
+		std::string uuid;
+		OBSSource source;
+		std::vector<std::pair<BindingPtr, std::string>> values;
+		bool urgent;
+		// waiting in a queue, and being applied by a worker; a job
+		// that's in neither is dropped
+		bool queued;
+		bool running;
+	};
+	typedef std::shared_ptr<Job> JobPtr;
+
+	Receiver *receiver;
+
+	// one lock is plenty at the rate sources can be updated
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+	std::vector<std::thread> threads;
+
+	// a job taken from one queue is left behind in any other it's in,
+	// and skipped there, since it's no longer queued
+	std::unordered_map<std::string, JobPtr> jobs;
+	std::deque<JobPtr> urgentQueue;
+	std::vector<std::deque<JobPtr>> queues;
+
+	void enqueue(const JobPtr &job);
+	JobPtr take(size_t worker);
+	void run(size_t worker);
+};
+
+#endif // OBSSB_UPDATE_POOL_HPP
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <sstream>
+
+#include "receiver.hpp"
+#include "update-profile.hpp"
+
+UpdateProfile::UpdateProfile()
+{
+	started_ns = 0;
+}
+
+void UpdateProfile::resize(size_t capacity)
+{
+	written.resize(capacity, 0);
+	changed.resize(capacity, 0);
+}
+
+void UpdateProfile::reset(uint64_t now_ns)
+{
+	started_ns = now_ns;
+	std::fill(written.begin(), written.end(), 0);
+	std::fill(changed.begin(), changed.end(), 0);
+}
+
+uint32_t suggestPriority(double changeRate)
+{
+	if (changeRate >= PROFILE_IMMEDIATE_RATE)
+		return PRIORITY_IMMEDIATE;
+	if (changeRate >= PROFILE_LOW_RATE)
+		return PRIORITY_NORMAL;
+	return PRIORITY_LOW;
+}
+
+// sums up [offset, offset + length), or as much of it as has been counted
+static ProfileRow summarize(const UpdateProfile &profile, size_t offset,
+			    size_t length, double seconds)
+{
+	ProfileRow row = {};
+	row.offset = offset;
+	row.length = length;
+
+	const std::vector<uint32_t> &written = profile.writes();
+	const std::vector<uint32_t> &changed = profile.changes();
+	size_t end = std::min(offset + length, written.size());
+
+	uint32_t mostWritten = 0, mostChanged = 0;
+	for (size_t i = offset; i < end; i++) {
+		mostWritten = std::max(mostWritten, written[i]);
+		mostChanged = std::max(mostChanged, changed[i]);
+		row.bytesWritten += written[i];
+		row.bytesChanged += changed[i];
+	}
+
+	row.writeRate = mostWritten / seconds;
+	row.changeRate = mostChanged / seconds;
+	row.suggested = suggestPriority(row.changeRate);
+	return row;
+}
+
+ProfileReport
+buildProfileReport(const UpdateProfile &profile, const BindingSet &set,
+		   const std::vector<unsigned long long> &suppressed,
+		   uint64_t now_ns)
+{
+	ProfileReport report;
+
+	// a report straight after a reset would divide by nothing
+	report.seconds = std::max(
+		(double)(now_ns - profile.startedNs()) / 1000000000.0, 1.0);
+
+	for (size_t i = 0; i < set.bindings.size(); i++) {
+		const Binding &binding = *set.bindings[i];
+		if (!binding.inBounds())
+			continue;
+
+		ProfileRow row = summarize(profile, binding.item_number - 1,
+					   binding.field_length,
+					   report.seconds);
+		row.name = binding.name;
+		row.priority = binding.priority;
+		if (i < suppressed.size())
+			row.suppressed = suppressed[i];
+		report.bindings.push_back(std::move(row));
+	}
+
+	const std::vector<uint32_t> &written = profile.writes();
+	for (size_t begin = 0; begin < written.size();) {
+		if (!written[begin]) {
+			begin++;
+			continue;
+		}
+
+		size_t end = begin + 1;
+		while (end < written.size() && written[end] == written[begin])
+			end++;
+
+		ProfileRow row = summarize(profile, begin, end - begin,
+					   report.seconds);
+		for (auto &binding : set.bindings) {
+			size_t first = binding->item_number - 1;
+			if (binding->inBounds() && first < end &&
+			    first + binding->field_length > begin)
+				row.bindings++;
+		}
+		report.regions.push_back(std::move(row));
+
+		begin = end;
+	}
+
+	return report;
+}
+
+static void csvField(std::ostringstream &out, const std::string &str)
+{
+	if (str.find_first_of(",\"\r\n") == std::string::npos) {
+		out << str;
+		return;
+	}
+
+	out << '"';
+	for (char c : str) {
+		if (c == '"')
+			out << '"';
+		out << c;
+	}
+	out << '"';
+}
+
+static const char *priorityName(uint32_t priority)
+{
+	switch (priority) {
+	case PRIORITY_IMMEDIATE:
+		return "immediate";
+	case PRIORITY_NORMAL:
+		return "normal";
+	default:
+		return "low";
+	}
+}
+
+std::string ProfileReport::toCsv() const
+{
+	std::ostringstream out;
+	out << "kind,name,item,length,writes_per_s,changes_per_s,"
+	       "bytes_written,bytes_changed,priority,suggested,bindings,"
+	       "suppressed\n";
+
+	auto row = [&](const char *kind, const ProfileRow &r, bool binding) {
+		out << kind << ',';
+		csvField(out, r.name);
+		out << ',' << r.offset + 1 << ',' << r.length << ','
+		    << r.writeRate << ',' << r.changeRate << ','
+		    << r.bytesWritten << ',' << r.bytesChanged << ','
+		    << (binding ? priorityName(r.priority) : "") << ','
+		    << priorityName(r.suggested) << ',';
+		if (!binding)
+			out << r.bindings;
+		out << ',';
+		if (binding)
+			out << r.suppressed;
+		out << '\n';
+	};
+
+	for (auto &r : bindings)
+		row("binding", r, true);
+	for (auto &r : regions)
+		row("region", r, false);
+
+	return out.str();
+}
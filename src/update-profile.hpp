@@ -0,0 +1,98 @@
+#ifndef OBSSB_UPDATE_PROFILE_HPP
+#define OBSSB_UPDATE_PROFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct BindingSet;
+
+// fields changing at least this often, per second, are worth updating
+// immediately, and ones changing less than once a minute can wait
+#define PROFILE_IMMEDIATE_RATE 1.0
+#define PROFILE_LOW_RATE (1.0 / 60.0)
+
+// How often each byte of the score table is written by the feed, and how
+// often that write actually changed it. Counting is a loop over the range
+// being applied, which has to be looked at anyway. Only from the receiver's
+// thread.
+class UpdateProfile {
+public:
+	UpdateProfile();
+
+	// counts for offsets that are still in the table are kept
+	void resize(size_t capacity);
+
+	// forgets everything counted so far
+	void reset(uint64_t now_ns);
+
+	// data is about to replace before, both the same length
+	inline void record(size_t offset, const char *before,
+			   const std::string_view &data)
+	{
+		uint32_t *w = written.data() + offset;
+		uint32_t *c = changed.data() + offset;
+		for (size_t i = 0; i < data.size(); i++) {
+			w[i]++;
+			c[i] += before[i] != data[i];
+		}
+	}
+
+	inline uint64_t startedNs() const { return started_ns; }
+	inline const std::vector<uint32_t> &writes() const { return written; }
+	inline const std::vector<uint32_t> &changes() const { return changed; }
+
+private:
+	uint64_t started_ns;
+	std::vector<uint32_t> written;
+	std::vector<uint32_t> changed;
+};
+
+// A field's share of the profile. A field is written or changed as often as
+// its busiest byte is, and the byte counts say how much of it really moves.
+struct ProfileRow {
+	// empty for regions
+	std::string name;
+	size_t offset;
+	size_t length;
+
+	double writeRate;
+	double changeRate;
+	unsigned long long bytesWritten;
+	unsigned long long bytesChanged;
+
+	// see PRIORITY_*; regions only have the suggested one
+	uint32_t priority;
+	uint32_t suggested;
+
+	// for regions, how many bindings overlap them
+	size_t bindings;
+
+	// for bindings, changes held back and never applied, see
+	// Binding::hold_ms
+	unsigned long long suppressed;
+};
+
+// The profile summed up for each binding, and for each region: a run of
+// bytes that have all been written the same number of times, which is
+// usually a range the console sends as one.
+struct ProfileReport {
+	double seconds;
+	std::vector<ProfileRow> bindings;
+	std::vector<ProfileRow> regions;
+
+	std::string toCsv() const;
+};
+
+// the priority a field changing this often per second would do best with
+uint32_t suggestPriority(double changeRate);
+
+// suppressed has a count for each binding of the set, or is empty
+ProfileReport
+buildProfileReport(const UpdateProfile &profile, const BindingSet &set,
+		   const std::vector<unsigned long long> &suppressed,
+		   uint64_t now_ns);
+
+#endif // OBSSB_UPDATE_PROFILE_HPP
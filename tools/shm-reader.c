@@ -0,0 +1,219 @@
+/*
+ * Example reader for the score table the plugin exports to shared memory,
+ * built on src/obs-scoreboard-shm.h:
+ *
+ *   shm-reader [NAME]                    every range as it changes
+ *   shm-reader [NAME] ITEM:LEN...        those fields, whenever they change
+ *
+ * NAME is the one in the plugin's settings, "obs-scoreboard" if not given.
+ */
+
+/* for shm_open() and the futex wait, whatever -std says */
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "obs-scoreboard-shm.h"
+
+#define DEFAULT_NAME "obs-scoreboard"
+
+/* how long to sleep between looks without a futex to wait on */
+#define POLL_US 20000
+
+/* the most of a range that's printed */
+#define SHOW_MAX 60
+
+#define MAX_FIELDS 64
+
+struct field {
+	uint32_t offset;
+	uint32_t length;
+	char *shown;
+};
+
+static void show(const char *data, size_t length)
+{
+	size_t i;
+
+	putchar('\'');
+	for (i = 0; i < length && i < SHOW_MAX; i++)
+		putchar(data[i] >= 0x20 && data[i] < 0x7f ? data[i] : '.');
+	printf(length > SHOW_MAX ? "'...\n" : "'\n");
+}
+
+static int parseField(const char *text, struct field *out)
+{
+	unsigned long item, length;
+	char *end;
+
+	item = strtoul(text, &end, 10);
+	if (end == text || *end != ':' || !item)
+		return 0;
+	length = strtoul(end + 1, &end, 10);
+	if (*end || !length)
+		return 0;
+
+	out->offset = (uint32_t)(item - 1);
+	out->length = (uint32_t)length;
+	out->shown = NULL;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = DEFAULT_NAME;
+	struct field fields[MAX_FIELDS];
+	size_t nfields = 0;
+	char path[256];
+	struct stat st;
+	const struct obssb_shm_header *header;
+	struct obssb_shm_range ranges[OBSSB_SHM_LOG_SIZE];
+	char *table;
+	uint64_t seen = 0;
+	int first = 1;
+	int fd, i;
+
+	for (i = 1; i < argc; i++) {
+		if (strchr(argv[i], ':')) {
+			if (nfields == MAX_FIELDS ||
+			    !parseField(argv[i], &fields[nfields++])) {
+				fprintf(stderr, "bad field: %s\n", argv[i]);
+				return 2;
+			}
+		} else {
+			name = argv[i];
+		}
+	}
+
+	snprintf(path, sizeof(path), "/%s", name);
+	fd = shm_open(path, O_RDONLY, 0);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(path);
+		return 1;
+	}
+
+	header = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (header == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	if ((size_t)st.st_size < sizeof(*header) ||
+	    __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+		    OBSSB_SHM_MAGIC ||
+	    header->layout != OBSSB_SHM_LAYOUT ||
+	    (size_t)st.st_size < header->header_size + header->max_table) {
+		fprintf(stderr, "%s: not a score table export\n", path);
+		return 1;
+	}
+
+	table = calloc(header->max_table, 1);
+	if (!table)
+		return 1;
+
+	for (;;) {
+		uint32_t seq, capacity = 0;
+		uint64_t count = 0, version = 0, n;
+		int closed = 0, all = 0;
+		size_t nranges = 0;
+
+		do {
+			seq = obssb_shm_read_begin(header);
+			closed = header->closed;
+			capacity = header->capacity;
+			version = header->version;
+			count = header->log_count;
+			if (capacity > header->max_table)
+				continue;
+
+			/*
+			 * only the ranges logged since the last look are
+			 * copied, unless we've fallen out of the log
+			 */
+			all = first || count - seen > OBSSB_SHM_LOG_SIZE;
+			if (all) {
+				memcpy(table, obssb_shm_table(header),
+				       capacity);
+				continue;
+			}
+
+			nranges = 0;
+			for (n = seen; n < count; n++) {
+				struct obssb_shm_range r =
+					header->log[n % OBSSB_SHM_LOG_SIZE];
+
+				/* a torn read can say anything */
+				if (r.offset > capacity ||
+				    r.length > capacity - r.offset)
+					break;
+
+				memcpy(table + r.offset,
+				       obssb_shm_table(header) + r.offset,
+				       r.length);
+				ranges[nranges++] = r;
+			}
+		} while (obssb_shm_read_retry(header, seq));
+
+		if (closed) {
+			printf("export closed\n");
+			return 0;
+		}
+
+		if (all) {
+			ranges[0].offset = 0;
+			ranges[0].length = capacity;
+			ranges[0].version = version;
+			nranges = 1;
+		}
+
+		if (nfields) {
+			size_t f;
+
+			for (f = 0; f < nfields; f++) {
+				struct field *fl = &fields[f];
+
+				if (fl->offset + fl->length > capacity)
+					continue;
+				if (fl->shown &&
+				    !memcmp(fl->shown, table + fl->offset,
+					    fl->length))
+					continue;
+
+				if (!fl->shown)
+					fl->shown = malloc(fl->length);
+				memcpy(fl->shown, table + fl->offset,
+				       fl->length);
+				printf("%" PRIu64 " %u:%u ", version,
+				       fl->offset + 1, fl->length);
+				show(fl->shown, fl->length);
+			}
+		} else {
+			size_t r;
+
+			for (r = 0; r < nranges; r++) {
+				struct obssb_shm_range *range = &ranges[r];
+
+				printf("%" PRIu64 " %u:%u ", range->version,
+				       range->offset + 1, range->length);
+				show(table + range->offset, range->length);
+			}
+		}
+		fflush(stdout);
+
+		seen = count;
+		first = 0;
+
+#ifdef __linux__
+		obssb_shm_wait(header, seq, 1000);
+#else
+		usleep(POLL_US);
+#endif
+	}
+}
@@ -0,0 +1,148 @@
+// Example reader for the score sidecars written next to recordings, built on
+// the reader in src/sidecar.hpp:
+//
+//   sidecar-dump FILE                    when it was recorded and how long
+//   sidecar-dump FILE --at TIME          the score table at TIME
+//   sidecar-dump FILE --field ITEM:LEN   every value the field took, and when
+//
+// TIME is in seconds, or h:mm:ss / m:ss, from the start of the recording.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#include "sidecar.hpp"
+
+// items shown on each row of a dumped table
+#define DUMP_COLUMNS 20
+
+static bool parseTime(const char *text, uint64_t &time_us)
+{
+	double seconds = 0, part = 0;
+	char *end;
+
+	for (const char *p = text;; p = end + 1) {
+		part = strtod(p, &end);
+		if (end == p)
+			return false;
+		if (*end != ':')
+			break;
+		seconds = (seconds + part) * 60;
+	}
+	if (*end)
+		return false;
+
+	time_us = (uint64_t)((seconds + part) * 1000000);
+	return true;
+}
+
+static std::string formatTime(uint64_t time_us)
+{
+	uint64_t ms = time_us / 1000;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%" PRIu64 ":%02" PRIu64 ":%02" PRIu64
+		 ".%03" PRIu64,
+		 ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+	return buf;
+}
+
+static void dumpTable(const SidecarReader &reader, uint64_t time_us)
+{
+	std::string table;
+	reader.stateAt(time_us, table);
+
+	// blank rows are left out
+	for (size_t row = 0; row < table.size(); row += DUMP_COLUMNS) {
+		std::string text = table.substr(row, DUMP_COLUMNS);
+		if (text.find_first_not_of(' ') == std::string::npos)
+			continue;
+
+		for (auto &c : text) {
+			if (c < 0x20 || c >= 0x7f)
+				c = '.';
+		}
+		printf("%6zu  |%s|\n", row + 1, text.c_str());
+	}
+}
+
+static void dumpField(const SidecarReader &reader, size_t offset,
+		      size_t length)
+{
+	std::string table;
+	reader.stateAt(0, table);
+	table.resize(std::max(table.size(), offset + length), ' ');
+
+	std::string value = table.substr(offset, length);
+	printf("%s  |%s|\n", formatTime(0).c_str(), value.c_str());
+
+	reader.changes(0, UINT64_MAX, [&](const SidecarReader::Change &change) {
+		size_t end = change.offset + change.data.size();
+		if (end <= offset || change.offset >= offset + length)
+			return true;
+
+		if (table.size() < end)
+			table.resize(end, ' ');
+		std::copy(change.data.begin(), change.data.end(),
+			  table.begin() + change.offset);
+
+		// the record can cover the field without changing it
+		std::string now = table.substr(offset, length);
+		if (now != value) {
+			value = now;
+			printf("%s  |%s|\n", formatTime(change.time_us).c_str(),
+			       value.c_str());
+		}
+		return true;
+	});
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2 && argc != 4) {
+		fprintf(stderr,
+			"usage: %s FILE [--at TIME | --field ITEM:LENGTH]\n",
+			argv[0]);
+		return 1;
+	}
+
+	SidecarReader reader;
+	if (const char *error = reader.open(argv[1])) {
+		fprintf(stderr, "%s: %s\n", argv[1], error);
+		return 1;
+	}
+
+	if (argc == 2) {
+		time_t started = (time_t)(reader.startedMs() / 1000);
+		char when[64];
+		strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S",
+			 localtime(&started));
+		printf("recorded %s, %s long\n", when,
+		       formatTime(reader.duration()).c_str());
+		return 0;
+	}
+
+	if (strcmp(argv[2], "--at") == 0) {
+		uint64_t time_us;
+		if (!parseTime(argv[3], time_us)) {
+			fprintf(stderr, "invalid time: %s\n", argv[3]);
+			return 1;
+		}
+		dumpTable(reader, time_us);
+		return 0;
+	}
+
+	unsigned item, length;
+	if (strcmp(argv[2], "--field") != 0 ||
+	    sscanf(argv[3], "%u:%u", &item, &length) != 2 || item < 1 ||
+	    length < 1 || length > SCORE_TABLE_MAX_CAPACITY ||
+	    item - 1 > SCORE_TABLE_MAX_CAPACITY - length) {
+		fprintf(stderr, "expected --at TIME or --field ITEM:LENGTH\n");
+		return 1;
+	}
+
+	dumpField(reader, item - 1, length);
+	return 0;
+}